@@ -0,0 +1,143 @@
+
+#ifndef _ARENA_HPP_
+#define _ARENA_HPP_
+
+#include <cstddef>
+
+namespace sudoku
+{
+    /**
+     * \brief Bump allocator backed by large chunks of memory, made to serve
+     *        a PicoSAT instance through picosat_minit().
+     *
+     * Blocks are carved out of the current chunk. Freed blocks are kept in
+     * per size free lists and reused, and the most recent block can grow or
+     * shrink in place. reset() releases every block in one operation and
+     * keeps the reserved memory, merged into a single chunk, so the next
+     * PicoSAT instance does not need to ask the system for memory again.
+     *
+     * Not thread safe, every thread (worker) must use its own arena, see
+     * local().
+     */
+    class Arena
+    {
+    public:
+        // Size of the chunks requested to the system
+        static const size_t DEF_CHUNK_SIZE;
+
+        struct Stats
+        {
+            // Since the last reset
+            size_t allocations;
+            size_t deallocations;
+            size_t resizes;
+            size_t in_place_resizes;
+            size_t bytes_in_use;
+            size_t peak_bytes;
+
+            // Since the arena was created
+            size_t reserved_bytes;      // memory held from the system
+            size_t system_allocations;  // chunks requested to the system
+            size_t resets;
+        };
+
+        // construct/destroy
+        explicit Arena(size_t chunk_size = DEF_CHUNK_SIZE);
+        virtual ~Arena();
+
+        /**
+         * \brief Returns a block of, at least, the given bytes aligned to
+         *        16 bytes.
+         */
+        void* allocate(size_t bytes);
+
+        /**
+         * \brief Resizes a block returned by allocate(), keeping the first
+         *        min(old_bytes, new_bytes) bytes. Like realloc, a null block
+         *        is allocated and a new size of 0 frees the block.
+         */
+        void* resize(void* block, size_t old_bytes, size_t new_bytes);
+
+        /**
+         * \brief Returns a block to the arena so it can be reused.
+         */
+        void deallocate(void* block, size_t bytes);
+
+        /**
+         * \brief Releases all the blocks at once. The memory is kept for
+         *        the following allocations.
+         */
+        void reset();
+
+        /**
+         * \brief Same as reset(), but the memory is given back to the
+         *        system if the arena holds more than max_reserved bytes.
+         */
+        void reset(size_t max_reserved);
+
+        /**
+         * \brief Marks the arena as used by a solver. Returns false if it
+         *        was already in use.
+         */
+        bool acquire();
+
+        /**
+         * \brief Marks the arena as free to be used by another solver.
+         */
+        void release();
+
+        const Stats& stats() const;
+
+        /**
+         * \brief Arena of the calling thread.
+         */
+        static Arena& local();
+
+        // PicoSAT memory manager callbacks, the state is the arena
+        static void* picosatNew(void* arena, size_t bytes);
+        static void* picosatResize(void* arena, void* block,
+                                   size_t old_bytes, size_t new_bytes);
+        static void picosatDelete(void* arena, void* block, size_t bytes);
+
+    private:
+        struct Chunk
+        {
+            Chunk* next;
+            size_t size;
+        };
+
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        // Blocks up to SMALL_LIMIT bytes are rounded to ALIGNMENT, bigger
+        // ones to a power of two. There is a free list per rounded size.
+        static const size_t ALIGNMENT = 16;
+        static const size_t SMALL_LIMIT = 512;
+        static const int NUM_SIZE_CLASSES = 64;
+
+        static size_t roundSize(size_t bytes);
+        static int sizeClass(size_t rounded_bytes);
+
+        char* allocateFromChunk(size_t rounded_bytes);
+        Chunk* newChunk(size_t bytes);
+        void freeChunks();
+
+        // disabled methods, declared private and not implemented
+        Arena(const Arena&);
+        Arena& operator=(const Arena&);
+
+        // attributes
+        size_t chunk_size_;
+        Chunk* chunks_;         // the current chunk is the first one
+        char* top_;             // first free byte of the current chunk
+        char* end_;             // end of the current chunk
+        char* last_block_;      // most recent block of the current chunk
+        FreeBlock* free_lists_[NUM_SIZE_CLASSES];
+        bool in_use_;
+        Stats stats_;
+    };
+}
+
+#endif // _ARENA_HPP_
@@ -0,0 +1,189 @@
+
+#ifndef _CANDIDATE_GRID_HPP_
+#define _CANDIDATE_GRID_HPP_
+
+#include <cstdint>
+
+#include "Grid.hpp"
+
+namespace sudoku
+{
+    /**
+     * \brief The values still possible for every cell of a grid, as bit
+     *        masks, the pencil marks a person would write.
+     *
+     * Every cell keeps a mask with the bits 1 to 9 of its candidates and
+     * every unit a mask of the values placed in it, so placing a value is
+     * clearing one bit in its 20 peers and most questions asked by the
+     * solving techniques are a few mask operations. Copies are a memcpy.
+     */
+    class CandidateGrid
+    {
+    public:
+        typedef uint16_t Mask;
+
+        static const Mask ALL_VALUES = 0x3fe;   // bits 1 to 9
+        static const int NUM_PEERS = 20;
+
+        // construct/destroy
+        CandidateGrid();
+        explicit CandidateGrid(const Grid& grid);
+
+        /**
+         * \brief Places the values of the grid, every other value is a
+         *        candidate of the empty cells unless a peer has it.
+         *
+         * \returns false if a value is given twice in a unit, the grid is
+         *          left in an unspecified state.
+         */
+        bool reset(const Grid& grid);
+
+        /**
+         * \brief Sets the value of an empty cell, which must be one of its
+         *        candidates, and removes it from the candidates of its
+         *        peers. No checks.
+         */
+        void place(int cell, int value);
+
+        /**
+         * \brief Removes a candidate of a cell.
+         *
+         * \returns true if it was a candidate.
+         */
+        bool eliminate(int cell, int value);
+
+        // Candidates of a cell, 0 once it has a value
+        Mask candidates(int cell) const;
+        // Value of a cell or Grid::UNDEFINED_VALUE
+        int value(int cell) const;
+        // Values placed in the unit, numbered as in Grid::UNIT_CELLS
+        Mask placed(int unit) const;
+        // Cells of the unit, as bits 0 to 8, that have the candidate
+        Mask positions(int unit, int value) const;
+        // Number of cells without a value
+        int unsolved() const;
+
+        /**
+         * \brief Returns false if an empty cell has no candidates left or a
+         *        value can no longer be placed in some unit.
+         */
+        bool isConsistent() const;
+
+        /**
+         * \brief Returns the placed values as a grid.
+         */
+        Grid toGrid() const;
+
+        /**
+         * \brief The units of a cell, its row, column and box, and its 20
+         *        peers, the other cells of those units.
+         */
+        static const uint8_t* units(int cell);
+        static const uint8_t* peers(int cell);
+
+        /**
+         * \brief Returns true if two different cells share a unit.
+         */
+        static bool sees(int cell1, int cell2);
+
+    private:
+        // Units and peers of every cell, built before main()
+        struct Tables
+        {
+            uint8_t units[Grid::NUM_CELLS][3];
+            uint8_t peers[Grid::NUM_CELLS][NUM_PEERS];
+
+            Tables();
+        };
+
+        static const Tables TABLES;
+
+        // attributes
+        Mask candidates_[Grid::NUM_CELLS];
+        uint8_t values_[Grid::NUM_CELLS];
+        Mask placed_[Grid::NUM_UNITS];
+        int unsolved_;
+    };
+
+
+    // Inline functions
+    // ------------------------------------------------------------------------
+
+    inline void CandidateGrid::place(int cell, int value)
+    {
+        const uint8_t* cell_units = units(cell);
+        const uint8_t* cell_peers = peers(cell);
+        Mask bit = static_cast<Mask>(1 << value);
+
+        values_[cell] = static_cast<uint8_t>(value);
+        candidates_[cell] = 0;
+        for (int i = 0; i < 3; ++i)
+            placed_[cell_units[i]] |= bit;
+        for (int i = 0; i < NUM_PEERS; ++i)
+            candidates_[cell_peers[i]] &= static_cast<Mask>(~bit);
+        unsolved_ -= 1;
+    }
+
+    inline bool CandidateGrid::eliminate(int cell, int value)
+    {
+        Mask bit = static_cast<Mask>(1 << value);
+        if ((candidates_[cell] & bit) == 0)
+            return false;
+        candidates_[cell] &= static_cast<Mask>(~bit);
+        return true;
+    }
+
+    inline CandidateGrid::Mask CandidateGrid::candidates(int cell) const
+    {
+        return candidates_[cell];
+    }
+
+    inline int CandidateGrid::value(int cell) const
+    {
+        return values_[cell];
+    }
+
+    inline CandidateGrid::Mask CandidateGrid::placed(int unit) const
+    {
+        return placed_[unit];
+    }
+
+    inline CandidateGrid::Mask CandidateGrid::positions(int unit,
+                                                        int value) const
+    {
+        const uint8_t* cells = Grid::UNIT_CELLS[unit];
+        Mask bit = static_cast<Mask>(1 << value);
+        Mask positions = 0;
+        for (int i = 0; i < 9; ++i) {
+            if (candidates_[cells[i]] & bit)
+                positions |= static_cast<Mask>(1 << i);
+        }
+        return positions;
+    }
+
+    inline int CandidateGrid::unsolved() const
+    {
+        return unsolved_;
+    }
+
+    inline const uint8_t* CandidateGrid::units(int cell)
+    {
+        return TABLES.units[cell];
+    }
+
+    inline const uint8_t* CandidateGrid::peers(int cell)
+    {
+        return TABLES.peers[cell];
+    }
+
+    inline bool CandidateGrid::sees(int cell1, int cell2)
+    {
+        const uint8_t* units1 = units(cell1);
+        const uint8_t* units2 = units(cell2);
+        return cell1 != cell2 && (units1[0] == units2[0] ||
+                                  units1[1] == units2[1] ||
+                                  units1[2] == units2[2]);
+    }
+}
+
+#endif // _CANDIDATE_GRID_HPP_
@@ -0,0 +1,100 @@
+
+#ifndef _DEADLINE_HPP_
+#define _DEADLINE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace sudoku
+{
+    /**
+     * \brief A flag raised to cancel the solves that were given it in a
+     *        Deadline. Raising it is safe from any thread and from a signal
+     *        handler.
+     */
+    class CancellationToken
+    {
+    public:
+        CancellationToken() : cancelled_(false) { }
+
+        /**
+         * \brief Makes every deadline with this token expire.
+         */
+        void cancel() { cancelled_.store(true); }
+
+        /**
+         * \brief Lowers the flag, F.E: to reuse the token.
+         */
+        void reset() { cancelled_.store(false); }
+
+        bool cancelled() const { return cancelled_.load(); }
+
+    private:
+        // disabled methods, declared private and not implemented
+        CancellationToken(const CancellationToken&);
+        CancellationToken& operator=(const CancellationToken&);
+
+        std::atomic<bool> cancelled_;
+    };
+
+
+    /**
+     * \brief When a solve must give up: a point in time of the monotonic
+     *        clock, a cancellation token or both. The default deadline
+     *        never expires.
+     *
+     * All the methods are inline, checking a deadline only reads the clock
+     * and the token.
+     */
+    class Deadline
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        // Never expires
+        Deadline() : limited_(false), at_(), token_(NULL) { }
+
+        // Expires the given seconds from now
+        explicit Deadline(double seconds,
+                          const CancellationToken* token = NULL)
+            : limited_(true), at_(after(seconds)), token_(token) { }
+
+        // Expires at the given time
+        explicit Deadline(Clock::time_point at,
+                          const CancellationToken* token = NULL)
+            : limited_(true), at_(at), token_(token) { }
+
+        // Expires when the token is cancelled
+        explicit Deadline(const CancellationToken& token)
+            : limited_(false), at_(), token_(&token) { }
+
+        /**
+         * \brief Tells whether it can ever expire.
+         */
+        bool unlimited() const { return !limited_ && token_ == NULL; }
+
+        /**
+         * \brief Tells whether the time is up or the token was cancelled.
+         */
+        bool expired() const
+        {
+            return (token_ != NULL && token_->cancelled()) ||
+                   (limited_ && Clock::now() >= at_);
+        }
+
+    private:
+        static Clock::time_point after(double seconds)
+        {
+            return Clock::now() +
+                std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(seconds));
+        }
+
+        bool limited_;
+        Clock::time_point at_;
+        const CancellationToken* token_;
+    };
+}
+
+#endif // _DEADLINE_HPP_
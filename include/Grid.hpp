@@ -0,0 +1,251 @@
+
+#ifndef _GRID_HPP_
+#define _GRID_HPP_
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace sudoku
+{
+    /**
+     * \brief Values of the 81 cells of a sudoku, stored inline in row major
+     *        order so copies and moves are a memcpy. It knows nothing about
+     *        solving, see SudokuSolver.
+     *
+     * The values of every row, column and box are also kept as bit masks,
+     * updated by every setter, so a value can be checked against the rest
+     * of the grid in constant time and contradictory givens are found
+     * without solving the puzzle.
+     */
+    class Grid
+    {
+    public:
+        static const int UNDEFINED_VALUE;
+        static const int MIN_VALUE;
+        static const int MAX_VALUE;
+        static const int NUM_ROWS;
+        static const int NUM_COLUMNS;
+        static const int SUBREGION_NUM_ROWS;
+        static const int SUBREGION_NUM_COLUMNS;
+        static const int NUM_CELLS = 81;
+        static const int NUM_UNITS = 27;    // rows, columns and boxes
+
+        // Cell values in row major order, UNDEFINED_VALUE if unspecified
+        typedef std::array<uint8_t, NUM_CELLS> Cells;
+
+        /**
+         * \brief Read only view of the nine cells of a row, a column or a
+         *        box of the grid. It is only valid while the grid lives.
+         */
+        class Unit
+        {
+        public:
+            Unit(const uint8_t* cells, const uint8_t* indices);
+
+            // Value of the i-th cell of the unit, no range checks
+            int operator[](int i) const;
+            // Grid index, row * NUM_COLUMNS + column, of the i-th cell
+            int index(int i) const;
+            int size() const;
+
+        private:
+            const uint8_t* cells_;
+            const uint8_t* indices_;
+        };
+
+        // Constructors, an empty grid or the given cells
+        Grid();
+        explicit Grid(const Cells& cells);
+
+        /**
+         * \brief Parses 81 characters, from the top left cell to the bottom
+         *        right one, with '.' or '0' for the empty cells.
+         *
+         * \throw std::invalid_argument If the string is not made of 81
+         *        valid cells.
+         */
+        static Grid fromString(const std::string& str);
+
+        /**
+         * \brief Returns the grid as 81 characters with '.' for the empty
+         *        cells, the inverse of fromString().
+         */
+        std::string toString() const;
+
+        /**
+         * \brief Sets the value of the grid's cell (row, column).
+         *
+         * \throw std::out_of_range If any of the input parameters is out of
+         *        the valid range. The different ranges are: row [0-9),
+         *        column [0, 9), value [1, 9]
+         */
+        void setValue(int row, int column, int value);
+
+        /**
+         * \brief Gets the value of the grid's cell (row, column).
+         *
+         * \returns The cell value or UNDEFINED_VALUE if it is unspecified.
+         *
+         * \throw std::out_of_range If the (row, column) is out of the grid.
+         */
+        int getValue(int row, int column) const;
+
+        /**
+         * \brief Same as setValue() and getValue() without range checks,
+         *        for hot loops. setValueUnchecked() also accepts
+         *        UNDEFINED_VALUE to clear a cell.
+         */
+        void setValueUnchecked(int row, int column, int value);
+        int getValueUnchecked(int row, int column) const;
+
+        /**
+         * \brief Returns all the cells of the grid.
+         */
+        const Cells& getCells() const;
+
+        /**
+         * \brief Returns true if another cell of the row, column or box of
+         *        the cell (row, column) has the value. Constant time unless
+         *        the grid already repeats a value.
+         *
+         * \throw std::out_of_range As setValue().
+         */
+        bool conflicts(int row, int column, int value) const;
+
+        /**
+         * \brief Returns false if the values of the grid can not be part of
+         *        a solution because a row, column or box repeats a value,
+         *        an empty cell has no value left or a value missing from a
+         *        unit fits in none of its empty cells. A puzzle that passes
+         *        may still have no solution.
+         */
+        bool isValid() const;
+
+        /**
+         * \brief Same as isValid() but tells why the grid is not valid.
+         *
+         * \throw std::invalid_argument If the grid is not valid.
+         */
+        void validate() const;
+
+        /**
+         * \brief Views of the row, column or box (numbered in row major
+         *        order) i, in the range [0, 9). No range checks.
+         */
+        Unit row(int i) const;
+        Unit column(int i) const;
+        Unit box(int i) const;
+
+        bool operator==(const Grid& other) const;
+        bool operator!=(const Grid& other) const;
+
+        // Cell indices of every unit: rows, then columns, then boxes
+        static const uint8_t UNIT_CELLS[NUM_UNITS][9];
+
+    private:
+        void addValue(int row, int column, int value);
+        void removeValue(int row, int column, int value);
+        void updateUnitValues();
+        bool check(std::string* reason) const;
+
+        // Values of every unit as bits 1 to 9
+        typedef uint16_t Mask;
+
+        // attributes
+        Cells cells_;
+        Mask rows_[9];
+        Mask columns_[9];
+        Mask boxes_[9];
+        int repeated_;      // values set where a unit had them already
+    };
+
+
+    // Inline functions
+    // ------------------------------------------------------------------------
+
+    inline Grid::Unit::Unit(const uint8_t* cells, const uint8_t* indices)
+        : cells_(cells), indices_(indices)
+    { }
+
+    inline int Grid::Unit::operator[](int i) const
+    {
+        return cells_[indices_[i]];
+    }
+
+    inline int Grid::Unit::index(int i) const
+    {
+        return indices_[i];
+    }
+
+    inline int Grid::Unit::size() const
+    {
+        return 9;
+    }
+
+    inline void Grid::setValueUnchecked(int row, int column, int value)
+    {
+        int old_value = cells_[row * 9 + column];
+        if (old_value == value)
+            return;
+        if (old_value != UNDEFINED_VALUE)
+            removeValue(row, column, old_value);
+        if (value != UNDEFINED_VALUE)
+            addValue(row, column, value);
+    }
+
+    inline void Grid::addValue(int row, int column, int value)
+    {
+        Mask bit = static_cast<Mask>(1 << value);
+        int box = row / 3 * 3 + column / 3;
+        if ((rows_[row] | columns_[column] | boxes_[box]) & bit)
+            repeated_ += 1;
+        rows_[row] |= bit;
+        columns_[column] |= bit;
+        boxes_[box] |= bit;
+        cells_[row * 9 + column] = static_cast<uint8_t>(value);
+    }
+
+    inline void Grid::removeValue(int row, int column, int value)
+    {
+        cells_[row * 9 + column] = static_cast<uint8_t>(UNDEFINED_VALUE);
+        if (repeated_ > 0) {
+            // Other cells of the units may have the value too
+            updateUnitValues();
+            return;
+        }
+
+        Mask mask = static_cast<Mask>(~(1 << value));
+        rows_[row] &= mask;
+        columns_[column] &= mask;
+        boxes_[row / 3 * 3 + column / 3] &= mask;
+    }
+
+    inline int Grid::getValueUnchecked(int row, int column) const
+    {
+        return cells_[row * 9 + column];
+    }
+
+    inline const Grid::Cells& Grid::getCells() const
+    {
+        return cells_;
+    }
+
+    inline Grid::Unit Grid::row(int i) const
+    {
+        return Unit(cells_.data(), UNIT_CELLS[i]);
+    }
+
+    inline Grid::Unit Grid::column(int i) const
+    {
+        return Unit(cells_.data(), UNIT_CELLS[9 + i]);
+    }
+
+    inline Grid::Unit Grid::box(int i) const
+    {
+        return Unit(cells_.data(), UNIT_CELLS[18 + i]);
+    }
+
+}
+
+#endif // _GRID_HPP_
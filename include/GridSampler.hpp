@@ -0,0 +1,91 @@
+
+#ifndef _GRID_SAMPLER_HPP_
+#define _GRID_SAMPLER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+#include "Grid.hpp"
+#include "SolverPool.hpp"
+#include "SudokuSolver.hpp"
+
+namespace sudoku
+{
+    /**
+     * \brief Draws random filled grids.
+     *
+     * SEARCH fills the cell with the fewest candidates first, trying its
+     * candidates in a random order and backtracking on a dead end. SAT
+     * gives every literal a random phase and lets a pooled solver fill the
+     * empty grid, it is slower and its grids depend on what the solver
+     * has learned. Neither is exactly uniform over all the grids, applying
+     * a random symmetry to every grid, see setShuffle(), makes the grids
+     * of any symmetry class equally likely.
+     *
+     * A sampler is not thread-safe, use one per thread.
+     */
+    class GridSampler
+    {
+    public:
+        enum Method { SEARCH, SAT };
+
+        struct Stats
+        {
+            size_t grids;
+            size_t backtracks;      // values undone by SEARCH
+        };
+
+        // construct/destroy
+        explicit GridSampler(
+            unsigned long seed, Method method = SEARCH,
+            SolverPool& pool = SudokuSolver::defaultSolverPool());
+        virtual ~GridSampler();
+
+        /**
+         * \brief If enabled every grid is transformed by a random symmetry
+         *        before it is returned. Disabled by default.
+         */
+        void setShuffle(bool shuffle);
+
+        /**
+         * \brief Sets the grid to a new random filled grid.
+         *
+         * \throw std::runtime_error If SAT runs out of the memory budget
+         *        of the pool, even with a rebuilt solver.
+         */
+        void sample(Grid& grid);
+
+        /**
+         * \brief Returns the counters of the sampler.
+         */
+        const Stats& stats() const;
+
+    private:
+        void sampleBySearch(Grid& grid);
+        void sampleBySat(Grid& grid);
+        bool fill(int filled);
+
+        // disabled methods, declared private and not implemented
+        GridSampler(const GridSampler&);
+        GridSampler& operator=(const GridSampler&);
+
+        // attributes
+        SolverPool& pool_;
+        Method method_;
+        bool shuffle_;
+        std::mt19937 random_;
+
+        // SEARCH state, the used values as bits 1 to 9
+        uint8_t cells_[Grid::NUM_CELLS];
+        uint16_t rows_[9];
+        uint16_t columns_[9];
+        uint16_t boxes_[9];
+
+        int8_t model_[SudokuSolver::NUM_LITERALS];
+
+        Stats stats_;
+    };
+}
+
+#endif // _GRID_SAMPLER_HPP_
@@ -0,0 +1,62 @@
+
+#ifndef _HISTOGRAM_HPP_
+#define _HISTOGRAM_HPP_
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace sudoku
+{
+    /**
+     * \brief Distribution of durations in power of two buckets of
+     *        microseconds: [0, 1), [1, 2), [2, 4), ... Adding a sample is
+     *        constant time and no memory is allocated.
+     */
+    class Histogram
+    {
+    public:
+        static const int NUM_BUCKETS = 24;
+
+        // Constructor
+        Histogram();
+
+        /**
+         * \brief Adds a duration, in seconds, to the distribution.
+         */
+        void add(double seconds);
+
+        size_t count() const;
+        double total() const;       // seconds
+        double min() const;         // seconds
+        double max() const;         // seconds
+        double mean() const;        // seconds
+
+        /**
+         * \brief Returns an upper bound, in seconds, of the p-th fraction
+         *        of the samples (F.E: 0.99). It is the top of the bucket
+         *        that holds the percentile, or the maximum if lower.
+         */
+        double percentile(double p) const;
+
+        /**
+         * \brief Prints a summary and a bar per bucket, from the first to
+         *        the last non empty bucket.
+         */
+        void print(std::ostream& os, const std::string& name) const;
+
+    private:
+        void printBuckets(std::ostream& os) const;
+
+        static int bucketFor(double seconds);
+        static double bucketLimit(int bucket);   // top, in microseconds
+
+        size_t buckets_[NUM_BUCKETS];
+        size_t count_;
+        double total_;
+        double min_;
+        double max_;
+    };
+}
+
+#endif // _HISTOGRAM_HPP_
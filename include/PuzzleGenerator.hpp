@@ -0,0 +1,102 @@
+
+#ifndef _PUZZLE_GENERATOR_HPP_
+#define _PUZZLE_GENERATOR_HPP_
+
+#include <cstddef>
+#include <random>
+
+#include "Grid.hpp"
+#include "GridSampler.hpp"
+#include "PuzzleRater.hpp"
+#include "SolverPool.hpp"
+#include "SudokuSolver.hpp"
+
+namespace sudoku
+{
+    /**
+     * \brief Generates minimal puzzles with a unique solution.
+     *
+     * A random grid is sampled and its clues are removed one at a time in a
+     * random order, a clue is only put back if the puzzle has more than one
+     * solution without it. A clue needed by a puzzle is needed by all the
+     * puzzles with fewer clues, so a single pass leaves a minimal puzzle.
+     *
+     * All the checks of a grid run on one leased solver: a clause that
+     * rules out the known solution is added in a context of its own and
+     * every candidate puzzle is given as assumptions, a puzzle is unique
+     * when that is unsatisfiable.
+     *
+     * A generator is not thread-safe, use one per thread.
+     */
+    class PuzzleGenerator
+    {
+    public:
+        // Puzzles accepted by generate(). The decisions of the solver say
+        // little about how hard a puzzle is for a person, the rating does.
+        struct Filter
+        {
+            int min_clues;
+            int max_clues;
+            size_t min_decisions;   // taken by the solver to solve it
+            size_t max_decisions;
+            double min_rating;      // see PuzzleRater
+            double max_rating;
+        };
+
+        struct Stats
+        {
+            size_t grids;           // sampled grids
+            size_t checks;          // uniqueness checks
+            size_t rejected;        // minimal puzzles not in the filter
+        };
+
+        /**
+         * \brief Returns the filter that accepts every puzzle.
+         */
+        static Filter anyPuzzle();
+
+        // construct/destroy
+        explicit PuzzleGenerator(
+            unsigned long seed,
+            SolverPool& pool = SudokuSolver::defaultSolverPool());
+        virtual ~PuzzleGenerator();
+
+        /**
+         * \brief Generates minimal puzzles until one is accepted by the
+         *        filter. Minimal puzzles from random grids rarely have
+         *        fewer than 20 or more than 30 clues, a filter out of that
+         *        range may take very long, and so does a minimum rating
+         *        above 7.5.
+         */
+        void generate(const Filter& filter, Grid& puzzle, Grid& solution);
+
+        /**
+         * \brief Sets the puzzle to a random minimal puzzle whose unique
+         *        solution is the given filled grid.
+         */
+        void removeClues(const Grid& solution, Grid& puzzle);
+
+        /**
+         * \brief Returns the counters of the generator.
+         */
+        const Stats& stats() const;
+
+    private:
+        bool accepts(const Filter& filter, const Grid& puzzle);
+
+        // disabled methods, declared private and not implemented
+        PuzzleGenerator(const PuzzleGenerator&);
+        PuzzleGenerator& operator=(const PuzzleGenerator&);
+
+        // attributes
+        SolverPool& pool_;
+        SudokuSolver engine_;       // measures the accepted puzzles
+        PuzzleRater rater_;
+        std::mt19937 random_;
+        GridSampler sampler_;
+
+        Stats stats_;
+    };
+}
+
+#endif // _PUZZLE_GENERATOR_HPP_
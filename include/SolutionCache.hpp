@@ -0,0 +1,103 @@
+
+#ifndef _SOLUTION_CACHE_HPP_
+#define _SOLUTION_CACHE_HPP_
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "Grid.hpp"
+#include "Solver.hpp"
+#include "Symmetry.hpp"
+
+namespace sudoku
+{
+    /**
+     * \brief Bounded LRU cache of solved puzzles, keyed by their canonical
+     *        form, so a puzzle that is a symmetry of one already solved is
+     *        answered without solving it.
+     *
+     * Solutions are stored in the canonical frame and mapped back to the
+     * frame of every puzzle that hits them. Puzzles with several solutions
+     * get a valid one, not necessarily the one the solver would find. The
+     * cache can be shared by several threads.
+     */
+    class SolutionCache
+    {
+    public:
+        static const size_t DEF_CAPACITY;
+
+        // A puzzle looked up, to insert its solution after a miss
+        struct Key
+        {
+            Grid canonical;
+            Transform transform;    // from the puzzle to canonical
+        };
+
+        struct Stats
+        {
+            size_t lookups;
+            size_t hits;
+            size_t insertions;
+            size_t evictions;
+            size_t entries;
+            double canonicalize_seconds;
+            double lookup_seconds;  // hashing, locking and mapping back
+        };
+
+        // construct/destroy
+        explicit SolutionCache(size_t capacity = DEF_CAPACITY);
+        virtual ~SolutionCache();
+
+        /**
+         * \brief Looks the puzzle up. On a hit result and solution are set,
+         *        on a miss key can be given to insert() once it is solved.
+         */
+        bool lookup(const Grid& puzzle, Key& key,
+                    Solver::SOLVE_RESULT& result, Grid& solution);
+
+        /**
+         * \brief Stores the result of a missed puzzle, evicting the least
+         *        recently used entry if the cache is full. Only SATISFIABLE
+         *        and UNSATISFIABLE results are stored.
+         */
+        void insert(const Key& key, Solver::SOLVE_RESULT result,
+                    const Grid& solution);
+
+        /**
+         * \brief Returns the cache counters.
+         */
+        Stats stats() const;
+
+    private:
+        struct Entry
+        {
+            Grid canonical;
+            Solver::SOLVE_RESULT result;
+            Grid solution;          // in the canonical frame
+        };
+
+        struct GridHash
+        {
+            size_t operator()(const Grid& grid) const;
+        };
+
+        typedef std::list<Entry> EntryList;
+        typedef std::unordered_map<Grid, EntryList::iterator, GridHash> Index;
+
+        // disabled methods, declared private and not implemented
+        SolutionCache(const SolutionCache&);
+        SolutionCache& operator=(const SolutionCache&);
+
+        // attributes
+        size_t capacity_;
+
+        mutable std::mutex mutex_;      // guards everything below
+        EntryList entries_;             // most recently used first
+        Index index_;
+        Stats stats_;
+    };
+}
+
+#endif // _SOLUTION_CACHE_HPP_
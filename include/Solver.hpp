@@ -2,8 +2,12 @@
 #ifndef _SOLVER_H_
 #define _SOLVER_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
+#include "Arena.hpp"
+#include "Deadline.hpp"
 #include "picosat.h"
 
 namespace sudoku
@@ -15,19 +19,45 @@ namespace sudoku
         // A negative value means no limit.
         static const int DEF_DECISION_LIMIT; 
 
-        enum SOLVE_RESULT { UNSATISFIABLE, SATISFIABLE, UNKNOWN };
+        enum SOLVE_RESULT { UNSATISFIABLE, SATISFIABLE, UNKNOWN,
+                            OUT_OF_MEMORY };
         enum LITERAL_VALUE { FALSE, TRUE, UNDEFINED };
 
+        // PicoSAT counters, accumulated since the solver was created or
+        // cleared.
+        struct Stats
+        {
+            unsigned long long decisions;
+            unsigned long long propagations;
+            unsigned long long conflicts;
+            unsigned long long visits;
+            double seconds;             // time spent in solve()
+            int variables;
+            int original_clauses;
+            size_t peak_bytes;          // maximum bytes allocated at once
+        };
+
         /**
-         *
+         * \brief Creates a solver whose PicoSAT instance allocates its
+         *        memory from the arena of the calling thread, or from an
+         *        arena of its own if another solver of the thread is already
+         *        using it.
          */
         Solver();
 
         /**
-         *
+         * \brief Same as Solver() with a seed for the random number
+         *        generator of PicoSAT.
          */
         Solver(int seed);
 
+        /**
+         * \brief Creates a solver that allocates its memory from the given
+         *        arena, which must outlive the solver and can not be used by
+         *        anyone else meanwhile.
+         */
+        Solver(Arena& arena, int seed);
+
         /**
          *
          */
@@ -35,6 +65,10 @@ namespace sudoku
 
         /**
          * \brief Removes all the previously added clauses.
+         *
+         * The whole PicoSAT instance is dropped by resetting its arena, the
+         * memory is kept for the new instance unless it is more than the
+         * memory budget.
          */
         void clear();
 
@@ -44,9 +78,41 @@ namespace sudoku
          * \param decision_limit Limits the number of decisions taken to solve
          *        the formula. A negative value indicates infinite decisions.
          *
+         * \param deadline Makes it give up, returning UNKNOWN, once it has
+         *        expired. PicoSAT checks it every few decisions through
+         *        its interrupt hook, so it returns promptly. The default
+         *        deadline never expires and is never checked.
+         *
+         * The memory budget, if any, is checked the same way, the solve
+         * gives up with OUT_OF_MEMORY once it is exceeded. It returns
+         * OUT_OF_MEMORY right away if the budget was exceeded while adding
+         * the clauses.
+         *
          * \return True if the formula is satisfiable, flase otherwise.
          */
-        SOLVE_RESULT solve(int decision_limit = DEF_DECISION_LIMIT);
+        SOLVE_RESULT solve(int decision_limit = DEF_DECISION_LIMIT,
+                           const Deadline& deadline = Deadline());
+
+        /**
+         * \brief Limits the bytes the PicoSAT instance may have allocated
+         *        at once, as counted by its arena, 0 means no limit, the
+         *        default. Allocations are never refused, PicoSAT aborts the
+         *        whole process if one fails, so the budget is exceeded by
+         *        what it allocates between two checks: a clause while the
+         *        formula is built, a few decisions in solve().
+         *
+         * Once the budget is exceeded by addClause() no more clauses are
+         * added, the formula is incomplete and every solve() returns
+         * OUT_OF_MEMORY until clear().
+         */
+        void setMemoryBudget(size_t bytes);
+
+        /**
+         * \brief Tells whether the PicoSAT instance holds more memory than
+         *        the budget allows, or did while the formula was built.
+         *        Its learned clauses make most of it, clear() drops them.
+         */
+        bool overMemoryBudget() const;
 
         /**
          * \brief Adds the given literals as a clause.
@@ -61,6 +127,37 @@ namespace sudoku
          */
         void assumeLiteral(int literal);
 
+        /**
+         * \brief Assumes the given literal only for the next call to
+         *        solve(). Unlike assumeLiteral() no clause is added, so the
+         *        solver can be reused for other assumptions afterwards.
+         */
+        void assume(int literal);
+
+        /**
+         * \brief Opens a context, the clauses added until the matching
+         *        pop() are discarded by it. Contexts can be nested.
+         */
+        void push();
+
+        /**
+         * \brief Closes the innermost context opened by push().
+         */
+        void pop();
+
+        /**
+         * \brief Sets the value the literal is given when the solver picks
+         *        it as a decision: true if phase is positive, false if
+         *        negative, the default heuristic if 0.
+         */
+        void setDefaultPhase(int literal, int phase);
+
+        /**
+         * \brief Forgets the phases set and the values saved from previous
+         *        calls to solve().
+         */
+        void resetPhases();
+
         /**
          * \brief Returns the value of the specified literal after a calling 
          *        solve()
@@ -74,6 +171,52 @@ namespace sudoku
          */
         LITERAL_VALUE getLiteralValue(int literal) const;
 
+        /**
+         * \brief Reads the values of the variables 1 to size after a call to
+         *        solve() that has returned SATISFIABLE, with a single check
+         *        of the solver state.
+         *
+         * values[i] is set to 1 if the variable i + 1 is true, -1 if it is
+         * false and 0 if it is unknown or not used by the formula.
+         *
+         * \throw logic_error If the last call to solve hasn't been SATISFIABLE.
+         */
+        void readModel(int8_t* values, size_t size) const;
+
+        /**
+         * \brief Returns the assumptions used to prove the formula
+         *        unsatisfiable after a call to solve() that has returned
+         *        UNSATISFIABLE, an empty vector if no assumption was needed.
+         *
+         * \throw logic_error If the last call to solve hasn't been
+         *        UNSATISFIABLE.
+         */
+        std::vector<int> failedAssumptions() const;
+
+        /**
+         * \brief Same as failedAssumptions() but reduced, by solving again
+         *        without each of them, until none can be dropped and the
+         *        formula is still unsatisfiable.
+         *
+         * The reduction reuses the solver and the clauses it has learned, no
+         * clause is added to the formula. The assumptions are lost, they
+         * must be given again before the next call to solve().
+         *
+         * \throw logic_error If the last call to solve hasn't been
+         *        UNSATISFIABLE.
+         */
+        std::vector<int> minimalFailedAssumptions();
+
+        /**
+         * \brief Returns the solver counters.
+         */
+        Stats stats() const;
+
+        /**
+         * \brief Returns the counters of the arena used by PicoSAT.
+         */
+        const Arena::Stats& allocatorStats() const;
+
         /**
          * \brief Adds the necessary constraints to force that at least one of
          *        the literals evaluates to true.
@@ -93,7 +236,23 @@ namespace sudoku
         void addExactlyOneConstraint(const std::vector<int>& literals);
 
     private:
+        void init(Arena* arena);
+        void createPicosat();
+
+        bool exceedsMemoryBudget() const;
+
+        static int interrupted(void* solver);
+
+        // disabled methods, declared private and not implemented
+        Solver(const Solver&);
+        Solver& operator=(const Solver&);
+
+        Arena* arena_;
+        bool owns_arena_;
         PicoSAT* picosat_;
+        size_t memory_budget_;
+        bool budget_exceeded_;          // by the clauses, sticky
+        const Deadline* deadline_;      // of the solve() running
     };
 
 }
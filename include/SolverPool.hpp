@@ -0,0 +1,131 @@
+
+#ifndef _SOLVER_POOL_HPP_
+#define _SOLVER_POOL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "Arena.hpp"
+#include "Solver.hpp"
+
+namespace sudoku
+{
+    /**
+     * \brief Keeps solvers alive between uses, loaded with a base formula,
+     *        so a new problem only needs its own clauses or assumptions.
+     *
+     * Idle solvers are kept in a free list per thread, up to a limit, so
+     * taking and returning a solver in the same thread does not lock. The
+     * rest go to a list shared by all the threads.
+     *
+     * Users must not add permanent clauses that are not implied by the base
+     * formula, the problem specific part should be given as assumptions
+     * (Solver::assume()). Learned clauses stay valid and are reused, but a
+     * solver is rebuilt after a number of uses to bound its memory, or as
+     * soon as it is returned over the memory budget of the pool.
+     *
+     * Every pooled solver has an arena of its own, so solvers can move
+     * freely between threads. The pool must outlive its leases.
+     */
+    class SolverPool
+    {
+        struct Entry;
+
+    public:
+        // Loads the base formula into a new or rebuilt solver
+        typedef void (*Initializer)(Solver& solver);
+
+        static const size_t DEF_MAX_IDLE_PER_THREAD;
+        static const size_t DEF_MAX_USES;
+
+        struct Stats
+        {
+            size_t created;         // solvers built, rebuilds not included
+            size_t rebuilt;         // solvers cleared after max uses or
+                                    // over the memory budget
+            size_t leases;
+            size_t local_hits;      // leases served by the thread's list
+            size_t shared_hits;     // leases served by the shared list
+        };
+
+        /**
+         * \brief Scoped use of a pooled solver, returned on destruction.
+         */
+        class Lease
+        {
+        public:
+            explicit Lease(SolverPool& pool);
+            ~Lease();
+
+            Solver& operator*() const;
+            Solver* operator->() const;
+
+        private:
+            // disabled methods, declared private and not implemented
+            Lease(const Lease&);
+            Lease& operator=(const Lease&);
+
+            SolverPool& pool_;
+            Entry* entry_;
+        };
+
+        // construct/destroy
+        SolverPool(Initializer initializer = NULL,
+                   size_t max_idle_per_thread = DEF_MAX_IDLE_PER_THREAD,
+                   size_t max_uses = DEF_MAX_USES);
+        virtual ~SolverPool();
+
+        /**
+         * \brief Builds count solvers into the shared list ahead of time,
+         *        F.E: when a server starts.
+         */
+        void prewarm(size_t count);
+
+        /**
+         * \brief Sets the memory budget of every solver leased from now
+         *        on, see Solver::setMemoryBudget(). 0, the default, means
+         *        no limit.
+         */
+        void setMemoryBudget(size_t bytes);
+
+        /**
+         * \brief Returns the pool counters.
+         */
+        Stats stats() const;
+
+    private:
+        friend class Lease;
+        friend struct LocalCache;
+
+        Entry* acquire();
+        void release(Entry* entry);
+        Entry* createEntry();
+        void releaseShared(const std::vector<Entry*>& entries);
+
+        std::vector<Entry*>& localList();
+
+        // disabled methods, declared private and not implemented
+        SolverPool(const SolverPool&);
+        SolverPool& operator=(const SolverPool&);
+
+        // attributes
+        const unsigned long id_;
+        Initializer initializer_;
+        size_t max_idle_per_thread_;
+        size_t max_uses_;
+
+        std::atomic<size_t> memory_budget_;
+        std::atomic<size_t> leases_;
+        std::atomic<size_t> local_hits_;
+
+        mutable std::mutex mutex_;      // guards everything below
+        std::vector<Entry*> shared_;
+        std::vector<Entry*> all_;
+        size_t shared_hits_;
+        size_t rebuilt_;
+    };
+}
+
+#endif // _SOLVER_POOL_HPP_
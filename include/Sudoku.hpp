@@ -1,81 +1,74 @@
 
-
 #ifndef _SUDOKU99_H_
 #define _SUDOKU99_H_
 
-#include <map>
-#include <vector>
-#
-#include <utility>
-
+#include "Grid.hpp"
 #include "Solver.hpp"
+#include "SolverPool.hpp"
+#include "SudokuSolver.hpp"
 
 namespace sudoku
 {
-    class Sudoku
+    /**
+     * \brief A grid that solves itself, replacing its values with the
+     *        solution, through a SudokuSolver engine.
+     */
+    class Sudoku : public Grid
     {
     public:
-        typedef std::pair<std::pair<int, int>, int> ROWCOLUMNVALUE;
-
-        static const int UNDEFINED_VALUE;
-        static const int MIN_VALUE;
-        static const int MAX_VALUE;
-        static const int NUM_ROWS;
-        static const int NUM_COLUMNS;
-        static const int SUBREGION_NUM_ROWS;
-        static const int SUBREGION_NUM_COLUMNS;
+        typedef SudokuSolver::Timings Timings;
 
         // Constructor
         Sudoku();
+        explicit Sudoku(const Grid& grid);
 
         // Destructor
         virtual ~Sudoku();
 
         /**
-         * \brief Sets the value of the grid's cell (row, column).
+         * \brief Tries to solve the sudoku with the previous fixed values.
+         *
+         * The engine of the calling thread is used, which takes its solvers
+         * from SudokuSolver::defaultSolverPool().
          *
-         * \throw std::out_of_range If any of the input parameters is out of
-         *        the valid range. The different ranges are: row [0-9),
-         *        column [0, 9), value [1, 9]
+         * \returns true if a solution is found, false otherwise
          */
-        void setValue(int row, int column, int value);
+        Solver::SOLVE_RESULT solve();
 
         /**
-         * \brief Gets the value of the grid's cell (row, column).
-         *
-         * \returns The cell value or UNDEFINED_VALUE if it is unspecified.
-         *
-         * \throw std::out_of_range If the (row, column) is out of the grid.
+         * \brief Same as solve() with solvers of the given pool, which must
+         *        use SudokuSolver::addRulesConstraints() as its initializer.
          */
-        int getValue(int row, int column) const;
+        Solver::SOLVE_RESULT solve(SolverPool& pool);
 
         /**
-         * \brief Tries to solve the sudoku with the previous fixed values.
-         *
-         * \returns true if a solution is found, false otherwise
+         * \brief Same as solve() with the given engine, giving up with
+         *        UNKNOWN once the deadline expires.
          */
-        Solver::SOLVE_RESULT solve();
-
-
-    private:
-        void addOnlyOneValuePerCellConstraints(void);
-        void addDontRepeatInColumnConstraints(void);
-        void addDontRepeatInRowConstraints(void);
-        void addDontRepeatInSubRegionConstraints(void);
-        void addFixedValuesConstraints(void);
-        void setGridFromSolverProof(void);
+        Solver::SOLVE_RESULT solve(SudokuSolver& engine,
+                                   const Deadline& deadline = Deadline());
 
-        int getLiteralForRowColumnValue(int row, int column, int value);
-        void createLiteralForRowColumnValue(const ROWCOLUMNVALUE& rcv);
-        const ROWCOLUMNVALUE& getRowColumnValueForLiteral(int literal);
+        /**
+         * \brief Returns the counters of the solver used by the last call to
+         *        solve(), see SudokuSolver::getSolverStats().
+         */
+        const Solver::Stats& getSolverStats() const;
 
-        int **grid_;
+        /**
+         * \brief Returns the counters of the arena used by the solver in the
+         *        last call to solve(), see SudokuSolver::getAllocatorStats().
+         */
+        const Arena::Stats& getAllocatorStats() const;
 
-        Solver solver_;
+        /**
+         * \brief Returns the time spent in every phase of solve().
+         */
+        const Timings& getTimings() const;
 
-        int last_literal;
-        std::map<ROWCOLUMNVALUE, int> rcv_lit_mapping_;
-        std::map<int, ROWCOLUMNVALUE> lit_rcv_mapping_;
+    private:
+        Solver::Stats solver_stats_;
+        Arena::Stats allocator_stats_;
+        Timings timings_;
     };
 
 }
@@ -0,0 +1,36 @@
+
+#ifndef _SUDOKU_BINARY_OUTPUTTER_HPP_
+#define _SUDOKU_BINARY_OUTPUTTER_HPP_
+
+
+#include "Grid.hpp"
+#include "SudokuOutputter.hpp"
+
+
+namespace sudoku
+{
+    /**
+     * \brief Writes every grid as 81 bytes, row after row, each with the
+     *        value of the cell from 1 to 9 or 0 if it is empty. There are
+     *        no separators, a file of N grids has 81 * N bytes.
+     *
+     * If pairs are enabled output(puzzle, solution) writes the puzzle
+     * followed by the solution, 162 bytes.
+     */
+    class SudokuBinaryOutputter : public SudokuOutputter
+    {
+    public:
+        // construct/destroy
+        SudokuBinaryOutputter(std::ostream& out_stream, bool pairs = false);
+        virtual ~SudokuBinaryOutputter();
+
+        void output(const Grid&);
+        void output(const Grid& puzzle, const Grid& solution);
+
+    private:
+        bool pairs_;
+    };
+
+}
+
+#endif // _SUDOKU_BINARY_OUTPUTTER_HPP_
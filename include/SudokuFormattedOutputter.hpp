@@ -2,12 +2,14 @@
 #ifndef _SUDOKU_FORMATTED_OUTPUTTER_HPP_
 #define _SUDOKU_FORMATTED_OUTPUTTER_HPP_
 
+#include <string>
+#include <vector>
 
-#include "Sudoku.hpp"
+#include "Grid.hpp"
 #include "SudokuOutputter.hpp"
 
 
-namespace sudoku 
+namespace sudoku
 {
     class SudokuFormattedOutputter : public SudokuOutputter
     {
@@ -16,12 +18,18 @@ namespace sudoku
         SudokuFormattedOutputter(std::ostream& out_stream);
         virtual ~SudokuFormattedOutputter();
 
-        void output(const Sudoku&);
+        using SudokuOutputter::output;
+        void output(const Grid&);
 
     private:
 
-        void outputRowSeparator(int row);
-        void outputColumnSeparator(int column);
+        void appendRowSeparator(int row);
+        void appendColumnSeparator(int column);
+
+        // Whole grid with blank cells, built once, and the offset of every
+        // cell's digit inside it (row major order).
+        std::string template_;
+        std::vector<size_t> cell_offsets_;
     };
 
 }
@@ -0,0 +1,68 @@
+
+#ifndef _SUDOKU_JSON_OUTPUTTER_HPP_
+#define _SUDOKU_JSON_OUTPUTTER_HPP_
+
+#include <cstddef>
+
+#include "Grid.hpp"
+#include "Solver.hpp"
+#include "SudokuOutputter.hpp"
+#include "SudokuSolver.hpp"
+
+
+namespace sudoku
+{
+    /**
+     * \brief Writes every result as a JSON Lines record, one JSON object
+     *        per line, the answer to the records of SudokuJsonReader:
+     *
+     *   {"id":7,"status":"SATISFIABLE","solution":"4173698..."}
+     *
+     * The status is SATISFIABLE, UNSATISFIABLE, UNKNOWN or OUT_OF_MEMORY,
+     * or ERROR together with an "error" message if the record could not be
+     * read. The solution, in the line format, is only written when there
+     * is one. The counters of the solver go in a "stats" object and the
+     * time of every phase in a "timings" one, in microseconds, when they
+     * are given.
+     *
+     * Records are formatted straight into the buffer of the outputter,
+     * without any allocation once it has grown.
+     */
+    class SudokuJsonOutputter : public SudokuOutputter
+    {
+    public:
+        struct Record
+        {
+            const char* id;             // raw JSON, written verbatim
+            size_t id_length;
+            Solver::SOLVE_RESULT result;
+            const Grid* solution;       // written if SATISFIABLE
+            const char* error;          // status ERROR if not NULL
+
+            // Left out if NULL
+            const Solver::Stats* stats;
+            const SudokuSolver::Timings* timings;
+            double parse;               // seconds, written with timings
+        };
+
+        // construct/destroy
+        SudokuJsonOutputter(std::ostream& out_stream);
+        virtual ~SudokuJsonOutputter();
+
+        /**
+         * \brief Writes a record without id for a solved grid.
+         */
+        void output(const Grid&);
+
+        void output(const Record& record);
+
+        /**
+         * \brief Returns the status written for a result, F.E:
+         *        "SATISFIABLE".
+         */
+        static const char* statusName(Solver::SOLVE_RESULT result);
+    };
+
+}
+
+#endif // _SUDOKU_JSON_OUTPUTTER_HPP_
@@ -0,0 +1,79 @@
+
+#ifndef _SUDOKU_JSON_READER_HPP_
+#define _SUDOKU_JSON_READER_HPP_
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+#include "Grid.hpp"
+#include "SudokuReader.hpp"
+
+
+namespace sudoku
+{
+    /**
+     * \brief Reads puzzles from a stream of JSON Lines records, one JSON
+     *        object per line such as {"id": 7, "puzzle": "4.....8.5.3..."}.
+     *
+     * The puzzle is a string in the line format of SudokuReader. The id is
+     * optional, any string or number, and is kept as the raw JSON text so
+     * it can be echoed back verbatim. Other members, nested or not, are
+     * skipped. Empty lines are ignored.
+     *
+     * Records are scanned in place in a line buffer that is reused, so
+     * reading a well-formed record does not allocate once the buffer is as
+     * long as the longest line.
+     */
+    class SudokuJsonReader
+    {
+    public:
+        struct Record
+        {
+            Grid puzzle;
+            const char* id;         // raw JSON, "null" if there is none,
+            size_t id_length;       // valid until the next read
+        };
+
+        // construct/destroy
+        SudokuJsonReader(std::istream& in_stream);
+        virtual ~SudokuJsonReader();
+
+        /**
+         * \brief Reads the next record of the stream.
+         *
+         * \returns false if there are no more records in the stream.
+         *
+         * \throw IOError If the record is malformed. The id is still set if
+         *        it could be found and the reader can be used to read the
+         *        following lines.
+         */
+        bool read(Record& record);
+
+        /**
+         * \brief Number of the last line read from the stream.
+         */
+        int getLineNumber() const;
+
+        /**
+         * \brief Parses a single record, the JSON object in [begin, end).
+         *        The id points into the given characters.
+         *
+         * \throw IOError As read().
+         */
+        static void parseRecord(const char* begin, const char* end,
+                                Record& record);
+
+    private:
+        // disabled methods, declared private and not implemented
+        SudokuJsonReader(const SudokuJsonReader&);
+        SudokuJsonReader& operator=(const SudokuJsonReader&);
+
+        // attributes
+        std::istream& in_stream_;
+        std::string line_;
+        int line_num_;
+    };
+}
+
+#endif // _SUDOKU_JSON_READER_HPP_
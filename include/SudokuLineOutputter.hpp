@@ -0,0 +1,38 @@
+
+#ifndef _SUDOKU_LINE_OUTPUTTER_HPP_
+#define _SUDOKU_LINE_OUTPUTTER_HPP_
+
+
+#include "Grid.hpp"
+#include "SudokuOutputter.hpp"
+
+
+namespace sudoku
+{
+    /**
+     * \brief Writes every grid in a single line of 81 characters, row after
+     *        row, with '.' for the empty cells. This is the same format
+     *        accepted as input.
+     *
+     * If pairs are enabled output(puzzle, solution) writes both grids
+     * separated by a comma: "<puzzle>,<solution>".
+     */
+    class SudokuLineOutputter : public SudokuOutputter
+    {
+    public:
+        // construct/destroy
+        SudokuLineOutputter(std::ostream& out_stream, bool pairs = false);
+        virtual ~SudokuLineOutputter();
+
+        void output(const Grid&);
+        void output(const Grid& puzzle, const Grid& solution);
+
+    private:
+        static void formatGrid(const Grid& sudoku, char* out);
+
+        bool pairs_;
+    };
+
+}
+
+#endif // _SUDOKU_LINE_OUTPUTTER_HPP_
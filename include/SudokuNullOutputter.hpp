@@ -0,0 +1,29 @@
+
+#ifndef _SUDOKU_NULL_OUTPUTTER_HPP_
+#define _SUDOKU_NULL_OUTPUTTER_HPP_
+
+
+#include "Grid.hpp"
+#include "SudokuOutputter.hpp"
+
+
+namespace sudoku
+{
+    /**
+     * \brief Discards every grid, the stream is never written. Useful to
+     *        measure the solving throughput without the formatting costs.
+     */
+    class SudokuNullOutputter : public SudokuOutputter
+    {
+    public:
+        // construct/destroy
+        SudokuNullOutputter(std::ostream& out_stream);
+        virtual ~SudokuNullOutputter();
+
+        void output(const Grid&);
+        void output(const Grid& puzzle, const Grid& solution);
+    };
+
+}
+
+#endif // _SUDOKU_NULL_OUTPUTTER_HPP_
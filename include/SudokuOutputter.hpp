@@ -2,9 +2,11 @@
 #ifndef _SUDOKU_OUTPUTTER_HPP_
 #define _SUDOKU_OUTPUTTER_HPP_
 
+#include <cstddef>
 #include <iosfwd>
+#include <vector>
 
-#include "Sudoku.hpp"
+#include "Grid.hpp"
 
 namespace sudoku
 {
@@ -15,12 +17,63 @@ namespace sudoku
         SudokuOutputter(std::ostream& output_stream);
         virtual ~SudokuOutputter();
 
-        virtual void output(const Sudoku& sudoku) = 0;
+        virtual void output(const Grid& sudoku) = 0;
+
+        /**
+         * \brief Outputs the solution of a puzzle together with the puzzle
+         *        itself. By default only the solution is written.
+         */
+        virtual void output(const Grid& puzzle, const Grid& solution);
+
+        /**
+         * \brief Writes all the buffered grids to the stream and flushes it.
+         */
+        void flush();
+
+        /**
+         * \brief Sets the number of bytes that may be kept in the internal
+         *        buffer before they are written to the stream.
+         *
+         * With the default value, 0, every grid is written to the stream
+         * with a single call as soon as it has been formatted. A larger value
+         * groups several grids into one write, which is what batch runs
+         * want. Pending bytes are always written by flush() and on
+         * destruction.
+         */
+        void setBufferSize(size_t bytes);
+
+        /**
+         * \brief If enabled the stream is flushed after every grid, not only
+         *        when flush() is called explicitly. Disabled by default.
+         */
+        void setAutoFlush(bool auto_flush);
 
     protected:
         std::ostream& getStream();
 
+        /**
+         * \brief Appends size bytes at the end of the internal buffer and
+         *        returns a pointer to the first of them.
+         *
+         * The returned pointer is valid until the next call to reserve() or
+         * commit().
+         */
+        char* reserve(size_t size);
+
+        /**
+         * \brief Marks the end of a grid. Writes and flushes the buffer
+         *        according to the buffer size and auto flush settings.
+         */
+        void commit();
+
+        /**
+         * \brief Same as commit() for a grid that ends before the bytes
+         *        reserved for it, the ones from end on are given back.
+         */
+        void commit(const char* end);
+
     private:
+        void writeBuffer();
 
         // disabled methods, declared private and not implemented
         SudokuOutputter();
@@ -29,6 +82,9 @@ namespace sudoku
 
         // attributes
         std::ostream& out_stream_;
+        std::vector<char> buffer_;
+        size_t buffer_size_;
+        bool auto_flush_;
     };
 }
 
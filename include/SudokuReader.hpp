@@ -0,0 +1,83 @@
+
+#ifndef _SUDOKU_READER_HPP_
+#define _SUDOKU_READER_HPP_
+
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+
+#include "Grid.hpp"
+
+
+namespace sudoku
+{
+    class IOError : public std::runtime_error
+    {
+    public:
+        IOError(const std::string& what) : std::runtime_error(what) { }
+    };
+
+
+    /**
+     * \brief Reads sudokus from a stream in any of the supported formats.
+     *
+     * The "<row> <column> value" format describes a single sudoku with one
+     * cell per line, rows and columns starting at 1. The line format holds
+     * one sudoku per line as 81 characters from the top left cell to the
+     * bottom right one, with '.' or '0' for the empty cells; empty lines and
+     * lines starting with '#' are ignored. The format is detected from the
+     * first characters of the stream.
+     */
+    class SudokuReader
+    {
+    public:
+        // construct/destroy
+        SudokuReader(std::istream& in_stream);
+        virtual ~SudokuReader();
+
+        /**
+         * \brief Reads the next sudoku of the stream into sudoku.
+         *
+         * \returns false if there are no more sudokus in the stream.
+         *
+         * \throw IOError If the sudoku is malformed. In the line format the
+         *        reader can still be used to read the following lines.
+         * \throw std::out_of_range If any cell is out of the grid.
+         */
+        bool read(Grid& sudoku);
+
+        /**
+         * \brief True if the stream holds one sudoku per line.
+         */
+        bool isLineFormat() const;
+
+        /**
+         * \brief Number of the last line read from the stream.
+         */
+        int getLineNumber() const;
+
+        /**
+         * \brief Parses a single sudoku in the line format.
+         *
+         * \throw IOError If the line is not made of 81 valid cells.
+         */
+        static void parseLine(const std::string& line, Grid& sudoku);
+
+    private:
+        bool detectLineFormat();
+        void readCells(Grid& sudoku);
+
+        // disabled methods, declared private and not implemented
+        SudokuReader(const SudokuReader&);
+        SudokuReader& operator=(const SudokuReader&);
+
+        // attributes
+        std::istream& in_stream_;
+        std::string line_;
+        int line_num_;
+        bool line_format_;
+        bool done_;
+    };
+}
+
+#endif // _SUDOKU_READER_HPP_
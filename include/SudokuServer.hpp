@@ -0,0 +1,156 @@
+
+#ifndef _SUDOKU_SERVER_HPP_
+#define _SUDOKU_SERVER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Deadline.hpp"
+#include "PuzzleRater.hpp"
+#include "SudokuSolver.hpp"
+
+namespace sudoku
+{
+    class ServerError : public std::runtime_error
+    {
+    public:
+        ServerError(const std::string& what) : std::runtime_error(what) { }
+    };
+
+
+    /**
+     * \brief Solves sudokus sent through a Unix domain socket.
+     *
+     * The protocol is line based. Every request is a puzzle as 81
+     * characters, as in the line format of SudokuReader, and is answered
+     * with a single line:
+     *
+     *     OK <solution as 81 characters>
+     *     UNSAT
+     *     UNKNOWN
+     *     ERROR <reason>
+     *
+     * A request "HINT <puzzle>" asks for the next value a person could
+     * place instead, see PuzzleRater::hint(), and is answered with
+     * "HINT <row> <column> <value> <technique>", rows and columns from 1,
+     * or "NOHINT".
+     *
+     * A client may send any number of requests without waiting for the
+     * responses, which are always written in the order of the requests.
+     * Empty lines are ignored. With a request timeout a puzzle not solved
+     * that long after it was read, waiting included, is answered UNKNOWN.
+     *
+     * A single thread runs an epoll loop that accepts the connections and
+     * reads and writes all the sockets, the puzzles are solved by a pool of
+     * worker threads with a SudokuSolver engine and a PuzzleRater each.
+     */
+    class SudokuServer
+    {
+    public:
+        // Longest request line accepted, the connection is closed otherwise
+        static const size_t DEF_MAX_LINE_LENGTH;
+        // Requests of a connection being solved before it stops reading
+        static const size_t DEF_MAX_PIPELINE;
+
+        // construct/destroy
+        // The cache, if any, is shared by the workers and must outlive run().
+        // A request timeout of 0 seconds, the default, means no limit.
+        SudokuServer(const std::string& socket_path, size_t num_workers,
+                     SolutionCache* cache = NULL,
+                     double request_timeout = 0);
+        virtual ~SudokuServer();
+
+        /**
+         * \brief Listens on the socket and serves the clients until stop()
+         *        is called. A stale socket file at the path is replaced.
+         *
+         * \throw ServerError If the socket can not be set up.
+         */
+        void run();
+
+        /**
+         * \brief Makes run() return after closing all the connections,
+         *        the solves running are cancelled. It is safe to call from
+         *        a signal handler.
+         */
+        void stop();
+
+    private:
+        struct Connection;
+
+        struct Job
+        {
+            uint64_t connection_id;
+            uint64_t seq;
+            std::string line;
+            Deadline deadline;
+        };
+
+        struct Result
+        {
+            uint64_t connection_id;
+            uint64_t seq;
+            std::string response;
+        };
+
+        void setUp();
+        void tearDown();
+
+        void acceptConnections();
+        void readConnection(Connection& conn);
+        void parseRequests(Connection& conn);
+        void writeConnection(Connection& conn);
+        void updateEvents(Connection& conn);
+        void closeConnection(Connection& conn);
+        void deliverResults();
+
+        void workerLoop();
+        static std::string respond(SudokuSolver& engine, PuzzleRater& rater,
+                                   const std::string& line,
+                                   const Deadline& deadline);
+        Deadline requestDeadline() const;
+
+        // disabled methods, declared private and not implemented
+        SudokuServer(const SudokuServer&);
+        SudokuServer& operator=(const SudokuServer&);
+
+        // attributes
+        std::string socket_path_;
+        size_t num_workers_;
+        SolutionCache* cache_;
+        size_t max_line_length_;
+        size_t max_pipeline_;
+        double request_timeout_;
+
+        int listen_fd_;
+        bool bound_;        // the socket file is ours to remove
+        int epoll_fd_;
+        int wake_fd_;       // eventfd, signaled by workers and stop()
+        std::atomic<bool> stopping_;
+        CancellationToken cancel_;          // cancelled by stop()
+
+        std::map<uint64_t, Connection*> connections_;
+        uint64_t next_connection_id_;
+
+        std::vector<std::thread> workers_;
+
+        std::mutex jobs_mutex_;             // guards jobs_ and workers_done_
+        std::condition_variable jobs_cond_;
+        std::deque<Job> jobs_;
+        bool workers_done_;
+
+        std::mutex results_mutex_;          // guards results_
+        std::vector<Result> results_;
+    };
+}
+
+#endif // _SUDOKU_SERVER_HPP_
@@ -0,0 +1,110 @@
+
+#ifndef _SUDOKU_SESSION_HPP_
+#define _SUDOKU_SESSION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Grid.hpp"
+#include "Solver.hpp"
+#include "SolverPool.hpp"
+#include "SudokuSolver.hpp"
+
+namespace sudoku
+{
+    /**
+     * \brief A grid edited one value at a time, F.E: by a person in an
+     *        editor, that can be asked whether it still has a solution
+     *        after every edit.
+     *
+     * The session keeps a pooled solver, with the sudoku rules, for its
+     * whole life and gives it the values of the grid as assumptions, so
+     * an edit never rebuilds anything and the clauses learned by previous
+     * solves are kept. Every solve starts from the last solution, which
+     * is given to the solver as the phase of every literal, and the
+     * solver is not called at all when the last answer still holds: a
+     * value that agrees with the last solution or a cleared cell keep a
+     * grid solvable, a new value keeps it unsolvable.
+     *
+     * A session is not thread-safe, use one per thread.
+     */
+    class SudokuSession
+    {
+    public:
+        struct Stats
+        {
+            size_t edits;
+            size_t solves;
+            size_t solver_calls;    // solves the last answer did not settle
+        };
+
+        // construct/destroy
+        explicit SudokuSession(
+            SolverPool& pool = SudokuSolver::defaultSolverPool());
+        virtual ~SudokuSession();
+
+        /**
+         * \brief Sets the value of the cell (row, column).
+         *
+         * \throw std::out_of_range As Grid::setValue().
+         */
+        void set(int row, int column, int value);
+
+        /**
+         * \brief Clears the cell (row, column).
+         *
+         * \throw std::out_of_range As Grid::getValue().
+         */
+        void clear(int row, int column);
+
+        /**
+         * \brief Replaces all the values of the grid.
+         */
+        void reset(const Grid& grid);
+
+        /**
+         * \brief Returns the values set.
+         */
+        const Grid& grid() const;
+
+        /**
+         * \brief Tells whether the grid can be completed. The solution is
+         *        only written if the result is SATISFIABLE, UNKNOWN if the
+         *        deadline expired first. If the solver runs out of the
+         *        memory budget of the pool it is rebuilt, losing what it
+         *        has learned, and OUT_OF_MEMORY is returned.
+         */
+        Solver::SOLVE_RESULT solve(Grid& solution,
+                                   const Deadline& deadline = Deadline());
+
+        /**
+         * \brief Returns the counters of the solver in the last call to
+         *        solve() that used it, zero if it was not used.
+         */
+        const Solver::Stats& getSolverStats() const;
+
+        /**
+         * \brief Returns the counters of the session.
+         */
+        const Stats& stats() const;
+
+    private:
+        void solveGrid(const Deadline& deadline);
+
+        // disabled methods, declared private and not implemented
+        SudokuSession(const SudokuSession&);
+        SudokuSession& operator=(const SudokuSession&);
+
+        // attributes
+        SolverPool::Lease solver_;
+        Grid grid_;
+        Solver::SOLVE_RESULT result_;   // UNKNOWN if the grid changed since
+        Grid solution_;                 // last one found
+        int8_t model_[SudokuSolver::NUM_LITERALS];
+
+        Solver::Stats solver_stats_;
+        Stats stats_;
+    };
+}
+
+#endif // _SUDOKU_SESSION_HPP_
@@ -3,7 +3,7 @@
 #define _SUDOKU_SIMPLE_OUTPUTTER_HPP_
 
 
-#include "Sudoku.hpp"
+#include "Grid.hpp"
 #include "SudokuOutputter.hpp"
 
 
@@ -16,7 +16,8 @@ namespace sudoku
         SudokuSimpleOutputter(std::ostream& out_stream);
         virtual ~SudokuSimpleOutputter();
 
-        void output(const Sudoku&);
+        using SudokuOutputter::output;
+        void output(const Grid&);
 
     private:
     };
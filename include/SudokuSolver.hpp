@@ -0,0 +1,190 @@
+
+#ifndef _SUDOKU_SOLVER_HPP_
+#define _SUDOKU_SOLVER_HPP_
+
+#include <cstdint>
+#include <utility>
+
+#include "Grid.hpp"
+#include "SolutionCache.hpp"
+#include "Solver.hpp"
+#include "SolverPool.hpp"
+
+namespace sudoku
+{
+    /**
+     * \brief Solves grids with SAT solvers that have the sudoku rules
+     *        already loaded.
+     *
+     * Every call to solve() takes a solver from the pool, gives it the
+     * values of the puzzle as assumptions and returns it, so an engine can
+     * be kept per thread and any number of puzzles streamed through it. The
+     * engine owns the buffers used to read the model and the counters of
+     * the last solve, it is not thread-safe itself.
+     */
+    class SudokuSolver
+    {
+    public:
+        typedef std::pair<std::pair<int, int>, int> ROWCOLUMNVALUE;
+
+        static const int NUM_LITERALS = 729; // cells * values
+
+        // Answers of checkMinimal()
+        enum MINIMALITY { MINIMAL, NOT_MINIMAL, NOT_UNIQUE, NO_SOLUTION };
+
+        // Seconds spent in every phase of the last call to solve()
+        struct Timings
+        {
+            double encode;      // adding the constraints to the solver
+            double solve;       // running the SAT solver
+            double extract;     // reading the grid from the solver model
+        };
+
+        /**
+         * \brief Creates an engine that takes its solvers from the given
+         *        pool, which must use addRulesConstraints() as its
+         *        initializer and outlive the engine.
+         */
+        explicit SudokuSolver(SolverPool& pool = defaultSolverPool());
+        virtual ~SudokuSolver();
+
+        /**
+         * \brief Solves the puzzle. The solution is only written if the
+         *        result is SATISFIABLE, puzzle and solution may be the same
+         *        grid.
+         *
+         * Puzzles that are not Grid::isValid() are UNSATISFIABLE without
+         * taking a solver, their counters and timings are zero. The solve
+         * gives up with UNKNOWN once the deadline expires, see
+         * Solver::solve().
+         */
+        Solver::SOLVE_RESULT solve(const Grid& puzzle, Grid& solution,
+                                   const Deadline& deadline = Deadline());
+
+        /**
+         * \brief Tells why a puzzle has no solution. If the result is
+         *        UNSATISFIABLE conflict is set to a minimal subset of the
+         *        values of the puzzle that has no solution either: removing
+         *        any of them would make it solvable.
+         *
+         * The values are given to a single solver as assumptions and
+         * dropped one at a time while it is still unsatisfiable, so it
+         * takes as many solves as values the puzzle has at most, all of
+         * them reusing what the solver has learned. Neither the cache nor
+         * the counters and timings of solve() are used.
+         */
+        Solver::SOLVE_RESULT explain(const Grid& puzzle, Grid& conflict);
+
+        /**
+         * \brief Finds the backbone of a puzzle: if the result is
+         *        SATISFIABLE forced is set to the values that every
+         *        solution of the puzzle has, its own values included.
+         *
+         * Every empty cell starts with the value of a first solution. A
+         * clause that asks for another value in any of the cells left is
+         * added in a context of its own and the puzzle solved again, a
+         * model drops every cell whose value it changes and unsatisfiable
+         * means the cells left are forced. The solver tries the values left
+         * last, so a model tends to drop many cells at once. It takes a
+         * solve per model found, all of them on a single solver, the whole
+         * backbone of a puzzle with a unique solution takes two. Neither
+         * the cache nor the counters and timings of solve() are used.
+         */
+        Solver::SOLVE_RESULT backbone(const Grid& puzzle, Grid& forced);
+
+        /**
+         * \brief Tells whether a puzzle is minimal: it has a unique
+         *        solution and every one of its values is needed for that.
+         *        If the result is NOT_MINIMAL redundant is set to the values
+         *        that can be removed, one at a time, keeping the solution
+         *        unique, empty otherwise. Removing one of them may make
+         *        others needed.
+         *
+         * As in PuzzleGenerator::removeClues() a clause that rules out the
+         * solution is added to a single solver in a context of its own and
+         * the puzzle without each value is given as assumptions, the value
+         * is needed when that is unsatisfiable. It takes a solve per value
+         * plus two. Neither the cache nor the counters and timings of
+         * solve() are used.
+         */
+        MINIMALITY checkMinimal(const Grid& puzzle, Grid& redundant);
+
+        /**
+         * \brief Looks every puzzle up in the given cache, which must
+         *        outlive the engine, before solving it and stores the
+         *        result after a miss. NULL, the default, disables it.
+         *
+         * On a hit the solver counters and timings of the solve are zero.
+         */
+        void setCache(SolutionCache* cache);
+
+        /**
+         * \brief Returns the counters of the solver used by the last call to
+         *        solve(). Pooled solvers are reused, so the work counters only
+         *        include the work of that call.
+         */
+        const Solver::Stats& getSolverStats() const;
+
+        /**
+         * \brief Returns the counters of the arena used by the solver in the
+         *        last call to solve(). As with getSolverStats() the
+         *        allocation counters only include that call.
+         */
+        const Arena::Stats& getAllocatorStats() const;
+
+        /**
+         * \brief Returns the time spent in every phase of solve().
+         */
+        const Timings& getTimings() const;
+
+        /**
+         * \brief Adds the rules shared by every sudoku to the solver. This is
+         *        the initializer of the pools used by the engines.
+         */
+        static void addRulesConstraints(Solver& solver);
+
+        /**
+         * \brief Returns the process wide pool used by default.
+         */
+        static SolverPool& defaultSolverPool();
+
+        /**
+         * \brief Returns the literal that is true when the cell
+         *        (row, column) has the given value. Literals go from 1 to
+         *        NUM_LITERALS.
+         */
+        static int getLiteralForRowColumnValue(int row, int column,
+                                               int value);
+        static ROWCOLUMNVALUE getRowColumnValueForLiteral(int literal);
+
+        /**
+         * \brief Sets the grid from the values of the NUM_LITERALS literals,
+         *        as read by Solver::readModel(). Cells without a true
+         *        literal are left empty.
+         */
+        static void decodeModel(const int8_t* model, Grid& grid);
+
+    private:
+        static void addOnlyOneValuePerCellConstraints(Solver& solver);
+        static void addDontRepeatInColumnConstraints(Solver& solver);
+        static void addDontRepeatInRowConstraints(Solver& solver);
+        static void addDontRepeatInSubRegionConstraints(Solver& solver);
+        static void addFixedValuesConstraints(Solver& solver,
+                                              const Grid& puzzle);
+
+        // disabled methods, declared private and not implemented
+        SudokuSolver(const SudokuSolver&);
+        SudokuSolver& operator=(const SudokuSolver&);
+
+        // attributes
+        SolverPool& pool_;
+        SolutionCache* cache_;
+        int8_t model_[NUM_LITERALS];
+
+        Solver::Stats solver_stats_;
+        Arena::Stats allocator_stats_;
+        Timings timings_;
+    };
+}
+
+#endif // _SUDOKU_SOLVER_HPP_
@@ -0,0 +1,69 @@
+
+#ifndef _SYMMETRY_HPP_
+#define _SYMMETRY_HPP_
+
+#include <cstdint>
+#include <random>
+
+#include "Grid.hpp"
+
+namespace sudoku
+{
+    /**
+     * \brief A symmetry of the sudoku grid: an optional transposition,
+     *        followed by a permutation of the rows and one of the columns,
+     *        each keeping the bands and stacks together, and a relabeling
+     *        of the digits.
+     *
+     * Any grid is mapped to an equivalent one, a valid solution of a puzzle
+     * to a valid solution of the transformed puzzle.
+     */
+    struct Transform
+    {
+        bool transpose;
+        uint8_t rows[9];        // row i of the result is row rows[i]
+        uint8_t columns[9];     // column j of the result is column columns[j]
+        uint8_t digits[10];     // value v becomes digits[v], digits[0] = 0
+
+        /**
+         * \brief Returns the transform that leaves any grid unchanged.
+         */
+        static Transform identity();
+
+        /**
+         * \brief Returns a transform drawn uniformly from all the
+         *        symmetries.
+         */
+        static Transform random(std::mt19937& random);
+
+        /**
+         * \brief Returns the transformed grid.
+         */
+        Grid apply(const Grid& grid) const;
+
+        /**
+         * \brief Returns the transform that undoes this one.
+         */
+        Transform inverse() const;
+    };
+
+
+    /**
+     * \brief Returns the minimal lexicographic form of the grid, the
+     *        smallest of the 81 cells strings, empty cells as 0, over the
+     *        whole symmetry group. Two grids are equivalent if and only if
+     *        they have the same canonical form.
+     *
+     * If transform is not NULL it is set to a symmetry that maps the grid
+     * to its canonical form. Digits that do not appear in the grid are
+     * mapped to the labels left, in increasing order.
+     *
+     * Takes a few tens of microseconds for a puzzle. Valid filled grids,
+     * whose first row ties for every column order, are reduced by their
+     * smallest top band instead and take about 20 microseconds. It is
+     * thread-safe.
+     */
+    Grid canonicalize(const Grid& grid, Transform* transform = NULL);
+}
+
+#endif // _SYMMETRY_HPP_
@@ -0,0 +1,53 @@
+
+#ifndef _TIMER_HPP_
+#define _TIMER_HPP_
+
+#include <chrono>
+
+namespace sudoku
+{
+    /**
+     * \brief Measures elapsed wall time with the monotonic clock.
+     *
+     * All the methods are inline, reading the clock is the only cost, so
+     * it can be used around every phase of every solve.
+     */
+    class Timer
+    {
+    public:
+        // Starts measuring right away
+        Timer() : start_(Clock::now()) { }
+
+        /**
+         * \brief Starts measuring again from now.
+         */
+        void restart() { start_ = Clock::now(); }
+
+        /**
+         * \brief Returns the seconds elapsed since the timer was started.
+         */
+        double elapsed() const
+        {
+            return std::chrono::duration<double>(Clock::now() - start_).count();
+        }
+
+        /**
+         * \brief Returns the seconds elapsed since the timer was started and
+         *        starts measuring again from now.
+         */
+        double lap()
+        {
+            Clock::time_point now = Clock::now();
+            std::chrono::duration<double> seconds = now - start_;
+            start_ = now;
+            return seconds.count();
+        }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        Clock::time_point start_;
+    };
+}
+
+#endif // _TIMER_HPP_
@@ -67,6 +67,7 @@ IN THE SOFTWARE.
 #define MINRESTART	100	/* minimum restart interval */
 #define MAXRESTART	1000000 /* maximum restart interval */
 #define RDECIDE		1000	/* interval of random decisions */
+#define INTERRUPTLIM	16	/* decisions between interrupt checks */
 #define FRESTART	110	/* restart increase factor in percent */
 #define FREDUCE		110	/* reduce increase factor in percent  */
 #define FREDADJ		121	/* reduce increase adjustment factor */
@@ -608,6 +609,8 @@ struct PicoSAT
   unsigned long long lsimplify;
   unsigned long long propagations;
   unsigned long long lpropagations;
+  void * interrupt_state;
+  int (*interrupted) (void *);
   unsigned fixed;		/* top level assignments */
 #ifndef NFL
   unsigned failedlits;
@@ -5862,7 +5865,7 @@ decide (PS * ps)
 static int
 sat (PS * ps, int l)
 {
-  int count = 0, backtracked;
+  int count = 0, steps = 0, backtracked;
 
   if (!ps->conflict)
     bcp (ps);
@@ -5932,6 +5935,11 @@ SATISFIED:
       if (ps->propagations >= ps->lpropagations)/* propagation limit reached ? */
 	return PICOSAT_UNKNOWN;
 
+      if (ps->interrupted &&			/* interrupted from outside ? */
+	  !(++steps % INTERRUPTLIM) &&
+	  ps->interrupted (ps->interrupt_state))
+	return PICOSAT_UNKNOWN;
+
 #ifndef NADC
       if (!ps->adodisabled && ps->adoconflicts >= ps->adoconflictlimit)
 	{
@@ -7174,6 +7182,30 @@ picosat_deref (PS * ps, int int_lit)
   return 0;
 }
 
+int
+picosat_deref_model (PS * ps, signed char * values, int max_idx)
+{
+  int idx, n;
+
+  check_ready (ps);
+  check_sat_state (ps);
+  ABORTIF (max_idx < 0, "API usage: negative model size");
+  ABORTIF (ps->mtcls, "API usage: deref after empty clause generated");
+
+#ifdef STATS
+  ps->derefs++;
+#endif
+
+  n = (max_idx < (int) ps->max_var) ? max_idx : (int) ps->max_var;
+  for (idx = 1; idx <= n; idx++)
+    values[idx - 1] = ps->lits[2 * idx].val;
+
+  for (; idx <= max_idx; idx++)
+    values[idx - 1] = 0;
+
+  return n;
+}
+
 int
 picosat_deref_toplevel (PS * ps, int int_lit)
 {
@@ -7914,6 +7946,13 @@ picosat_set_propagation_limit (PS * ps, unsigned long long l)
   ps->lpropagations = l;
 }
 
+void
+picosat_set_interrupt (PS * ps, void * state, int (*interrupted) (void *))
+{
+  ps->interrupt_state = state;
+  ps->interrupted = interrupted;
+}
+
 unsigned long long
 picosat_propagations (PS * ps)
 {
@@ -7932,6 +7971,12 @@ picosat_decisions (PS * ps)
   return ps->decisions;
 }
 
+unsigned long long
+picosat_conflicts (PS * ps)
+{
+  return ps->conflicts;
+}
+
 int
 picosat_variables (PS * ps)
 {
@@ -291,6 +291,7 @@ double picosat_time_stamp (void);                       /* ... in process */
 void picosat_stats (PicoSAT *);                         /* > output file */
 unsigned long long picosat_propagations (PicoSAT *);	/* #propagations */
 unsigned long long picosat_decisions (PicoSAT *);	/* #decisions */
+unsigned long long picosat_conflicts (PicoSAT *);	/* #conflicts */
 unsigned long long picosat_visits (PicoSAT *);		/* #visits */
 
 /* The time spent in calls to the library or in 'picosat_sat' respectively.
@@ -430,6 +431,14 @@ int picosat_sat (PicoSAT *, int decision_limit);
  */
 void picosat_set_propagation_limit (PicoSAT *, unsigned long long limit);
 
+/* Makes 'picosat_sat' return 'PICOSAT_UNKNOWN' as soon as 'interrupted'
+ * returns non zero when called with 'state', which is done every few
+ * decisions, F.E: to stop at a deadline or from another thread.  A NULL
+ * function, the default, is never called.
+ */
+void picosat_set_interrupt (PicoSAT *,
+                            void * state, int (*interrupted) (void * state));
+
 /* Return last result of calling 'picosat_sat' or '0' if not called.
  */
 int picosat_res (PicoSAT *);
@@ -441,6 +450,13 @@ int picosat_res (PicoSAT *);
  */
 int picosat_deref (PicoSAT *, int lit);
 
+/* Same as 'picosat_deref' for the variables 1 to 'max_idx' at once, the
+ * value of variable 'idx' is stored in 'values[idx - 1]'.  Variables that
+ * are not used are stored as '0'.  Returns the number of used variables
+ * that have been stored.
+ */
+int picosat_deref_model (PicoSAT *, signed char * values, int max_idx);
+
 /* Same as before but just returns true resp. false if the literals is
  * forced to this assignment at the top level.  This function does not
  * require that 'picosat_sat' was called and also does not internally reset
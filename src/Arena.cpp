@@ -0,0 +1,301 @@
+//
+// File: Arena.cpp
+//
+
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <new>
+
+#include "Arena.hpp"
+
+
+namespace sudoku
+{
+    // A PicoSAT instance for a 9x9 sudoku peaks at less than 400KB
+    const size_t Arena::DEF_CHUNK_SIZE = 512 * 1024;
+
+    const size_t Arena::ALIGNMENT;
+    const size_t Arena::SMALL_LIMIT;
+    const int Arena::NUM_SIZE_CLASSES;
+
+    // Bytes taken by the chunk header, keeps the blocks aligned
+    static const size_t CHUNK_HEADER_SIZE = 32;
+
+
+    Arena::Arena(size_t chunk_size)
+        : chunk_size_(std::max(chunk_size, CHUNK_HEADER_SIZE + SMALL_LIMIT)),
+          chunks_(NULL),
+          top_(NULL),
+          end_(NULL),
+          last_block_(NULL),
+          in_use_(false),
+          stats_()
+    {
+        std::fill(free_lists_, free_lists_ + NUM_SIZE_CLASSES,
+                  static_cast<FreeBlock*>(NULL));
+    }
+
+
+    Arena::~Arena()
+    {
+        freeChunks();
+    }
+
+
+    void* Arena::allocate(size_t bytes)
+    {
+        if (bytes == 0)
+            return NULL;
+
+        size_t rounded = roundSize(bytes);
+        int size_class = sizeClass(rounded);
+
+        stats_.allocations += 1;
+        stats_.bytes_in_use += rounded;
+        stats_.peak_bytes = std::max(stats_.peak_bytes, stats_.bytes_in_use);
+
+        FreeBlock* block = free_lists_[size_class];
+        if (block != NULL) {
+            free_lists_[size_class] = block->next;
+            return block;
+        }
+
+        return allocateFromChunk(rounded);
+    }
+
+
+    void* Arena::resize(void* block, size_t old_bytes, size_t new_bytes)
+    {
+        if (block == NULL)
+            return allocate(new_bytes);
+
+        if (new_bytes == 0) {
+            deallocate(block, old_bytes);
+            return NULL;
+        }
+
+        stats_.resizes += 1;
+
+        size_t old_rounded = roundSize(old_bytes);
+        size_t new_rounded = roundSize(new_bytes);
+        char* ptr = static_cast<char*>(block);
+
+        bool in_place = false;
+        if (new_rounded == old_rounded) {
+            in_place = true;
+        } else if (ptr == last_block_ && ptr + new_rounded <= end_) {
+            top_ = ptr + new_rounded;   // the block is at the top
+            in_place = true;
+        }
+
+        if (in_place) {
+            stats_.in_place_resizes += 1;
+            stats_.bytes_in_use += new_rounded;
+            stats_.bytes_in_use -= old_rounded;
+            stats_.peak_bytes =
+                std::max(stats_.peak_bytes, stats_.bytes_in_use);
+            return block;
+        }
+
+        void* new_block = allocate(new_bytes);
+        ::memcpy(new_block, block, std::min(old_bytes, new_bytes));
+        deallocate(block, old_bytes);
+        return new_block;
+    }
+
+
+    void Arena::deallocate(void* block, size_t bytes)
+    {
+        if (block == NULL)
+            return;
+
+        size_t rounded = roundSize(bytes);
+
+        stats_.deallocations += 1;
+        stats_.bytes_in_use -= rounded;
+
+        if (block == last_block_) {
+            top_ = last_block_;   // give it back to the chunk
+            last_block_ = NULL;
+            return;
+        }
+
+        FreeBlock* free_block = static_cast<FreeBlock*>(block);
+        int size_class = sizeClass(rounded);
+        free_block->next = free_lists_[size_class];
+        free_lists_[size_class] = free_block;
+    }
+
+
+    void Arena::reset()
+    {
+        // Merge all the chunks into one, big enough to serve as much
+        // memory as the previous use without going back to the system
+        if (chunks_ != NULL && chunks_->next != NULL) {
+            size_t reserved = stats_.reserved_bytes;
+            freeChunks();
+            chunks_ = newChunk(reserved - CHUNK_HEADER_SIZE);
+        }
+
+        if (chunks_ != NULL) {
+            top_ = reinterpret_cast<char*>(chunks_) + CHUNK_HEADER_SIZE;
+            end_ = reinterpret_cast<char*>(chunks_) + chunks_->size;
+        }
+        last_block_ = NULL;
+        std::fill(free_lists_, free_lists_ + NUM_SIZE_CLASSES,
+                  static_cast<FreeBlock*>(NULL));
+
+        stats_.allocations = 0;
+        stats_.deallocations = 0;
+        stats_.resizes = 0;
+        stats_.in_place_resizes = 0;
+        stats_.bytes_in_use = 0;
+        stats_.peak_bytes = 0;
+        stats_.resets += 1;
+    }
+
+
+    void Arena::reset(size_t max_reserved)
+    {
+        if (stats_.reserved_bytes > max_reserved)
+            freeChunks();
+        reset();
+    }
+
+
+    bool Arena::acquire()
+    {
+        if (in_use_)
+            return false;
+        in_use_ = true;
+        return true;
+    }
+
+
+    void Arena::release()
+    {
+        in_use_ = false;
+    }
+
+
+    const Arena::Stats& Arena::stats() const
+    {
+        return stats_;
+    }
+
+
+    Arena& Arena::local()
+    {
+        static thread_local Arena arena;
+        return arena;
+    }
+
+
+    void* Arena::picosatNew(void* arena, size_t bytes)
+    {
+        return static_cast<Arena*>(arena)->allocate(bytes);
+    }
+
+
+    void* Arena::picosatResize(void* arena, void* block,
+                               size_t old_bytes, size_t new_bytes)
+    {
+        return static_cast<Arena*>(arena)->resize(block, old_bytes, new_bytes);
+    }
+
+
+    void Arena::picosatDelete(void* arena, void* block, size_t bytes)
+    {
+        static_cast<Arena*>(arena)->deallocate(block, bytes);
+    }
+
+
+    // ------------------------------------------------------------------------
+    // Private functions
+
+    size_t Arena::roundSize(size_t bytes)
+    {
+        if (bytes <= SMALL_LIMIT)
+            return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+        size_t rounded = SMALL_LIMIT * 2;
+        while (rounded < bytes)
+            rounded *= 2;
+        return rounded;
+    }
+
+
+    int Arena::sizeClass(size_t rounded_bytes)
+    {
+        if (rounded_bytes <= SMALL_LIMIT)
+            return static_cast<int>(rounded_bytes / ALIGNMENT) - 1;
+
+        int size_class = static_cast<int>(SMALL_LIMIT / ALIGNMENT);
+        for (size_t size = SMALL_LIMIT * 2; size < rounded_bytes; size *= 2)
+            ++size_class;
+        return std::min(size_class, NUM_SIZE_CLASSES - 1);
+    }
+
+
+    char* Arena::allocateFromChunk(size_t rounded_bytes)
+    {
+        // Big blocks that do not fit get a chunk of their own, the current
+        // one is kept
+        bool fits = chunks_ != NULL && top_ + rounded_bytes <= end_;
+        if (!fits && rounded_bytes > chunk_size_ / 2) {
+            Chunk* chunk = newChunk(rounded_bytes);
+            if (chunks_ == NULL) {
+                chunks_ = chunk;
+                chunk->next = NULL;
+                top_ = end_ = reinterpret_cast<char*>(chunk) + chunk->size;
+            } else {
+                chunk->next = chunks_->next;
+                chunks_->next = chunk;
+            }
+            return reinterpret_cast<char*>(chunk) + CHUNK_HEADER_SIZE;
+        }
+
+        if (!fits) {
+            Chunk* chunk = newChunk(chunk_size_ - CHUNK_HEADER_SIZE);
+            chunk->next = chunks_;
+            chunks_ = chunk;
+            top_ = reinterpret_cast<char*>(chunk) + CHUNK_HEADER_SIZE;
+            end_ = reinterpret_cast<char*>(chunk) + chunk->size;
+        }
+
+        last_block_ = top_;
+        top_ += rounded_bytes;
+        return last_block_;
+    }
+
+
+    Arena::Chunk* Arena::newChunk(size_t bytes)
+    {
+        size_t size = CHUNK_HEADER_SIZE + bytes;
+        Chunk* chunk = static_cast<Chunk*>(::malloc(size));
+        if (chunk == NULL)
+            throw std::bad_alloc();
+
+        chunk->next = NULL;
+        chunk->size = size;
+
+        stats_.reserved_bytes += size;
+        stats_.system_allocations += 1;
+        return chunk;
+    }
+
+
+    void Arena::freeChunks()
+    {
+        while (chunks_ != NULL) {
+            Chunk* next = chunks_->next;
+            stats_.reserved_bytes -= chunks_->size;
+            ::free(chunks_);
+            chunks_ = next;
+        }
+        top_ = end_ = last_block_ = NULL;
+    }
+
+}
@@ -0,0 +1,105 @@
+//
+// File: CandidateGrid.cpp
+//
+
+#include <cstring>
+
+#include "CandidateGrid.hpp"
+
+
+namespace sudoku
+{
+    const CandidateGrid::Mask CandidateGrid::ALL_VALUES;
+    const int CandidateGrid::NUM_PEERS;
+
+    const CandidateGrid::Tables CandidateGrid::TABLES;
+
+
+    CandidateGrid::Tables::Tables()
+    {
+        for (int cell = 0; cell < Grid::NUM_CELLS; ++cell) {
+            int row = cell / 9;
+            int column = cell % 9;
+            units[cell][0] = static_cast<uint8_t>(row);
+            units[cell][1] = static_cast<uint8_t>(9 + column);
+            units[cell][2] = static_cast<uint8_t>(18 + row / 3 * 3 +
+                                                  column / 3);
+        }
+
+        for (int cell = 0; cell < Grid::NUM_CELLS; ++cell) {
+            int count = 0;
+            for (int other = 0; other < Grid::NUM_CELLS; ++other) {
+                if (other != cell &&
+                    (units[cell][0] == units[other][0] ||
+                     units[cell][1] == units[other][1] ||
+                     units[cell][2] == units[other][2]))
+                    peers[cell][count++] = static_cast<uint8_t>(other);
+            }
+        }
+    }
+
+
+    CandidateGrid::CandidateGrid()
+    {
+        reset(Grid());
+    }
+
+
+    CandidateGrid::CandidateGrid(const Grid& grid)
+    {
+        reset(grid);
+    }
+
+
+    bool CandidateGrid::reset(const Grid& grid)
+    {
+        for (int i = 0; i < Grid::NUM_CELLS; ++i)
+            candidates_[i] = ALL_VALUES;
+        ::memset(values_, 0, sizeof(values_));
+        ::memset(placed_, 0, sizeof(placed_));
+        unsolved_ = Grid::NUM_CELLS;
+
+        bool valid = true;
+        const Grid::Cells& cells = grid.getCells();
+        for (int i = 0; i < Grid::NUM_CELLS; ++i) {
+            int value = cells[i];
+            if (value == Grid::UNDEFINED_VALUE)
+                continue;
+
+            const uint8_t* cell_units = units(i);
+            Mask bit = static_cast<Mask>(1 << value);
+            if ((placed_[cell_units[0]] | placed_[cell_units[1]] |
+                 placed_[cell_units[2]]) & bit)
+                valid = false;
+            place(i, value);
+        }
+        return valid;
+    }
+
+
+    bool CandidateGrid::isConsistent() const
+    {
+        for (int unit = 0; unit < Grid::NUM_UNITS; ++unit) {
+            const uint8_t* cells = Grid::UNIT_CELLS[unit];
+            Mask possible = placed_[unit];
+            for (int i = 0; i < 9; ++i) {
+                if (values_[cells[i]] == Grid::UNDEFINED_VALUE &&
+                    candidates_[cells[i]] == 0)
+                    return false;
+                possible |= candidates_[cells[i]];
+            }
+            if (possible != ALL_VALUES)
+                return false;
+        }
+        return true;
+    }
+
+
+    Grid CandidateGrid::toGrid() const
+    {
+        Grid::Cells cells;
+        ::memcpy(cells.data(), values_, Grid::NUM_CELLS);
+        return Grid(cells);
+    }
+
+}
@@ -0,0 +1,293 @@
+//
+// File: Grid.cpp
+//
+
+#include <cstring>
+
+#include <sstream>
+#include <stdexcept>
+
+#include "Grid.hpp"
+
+
+namespace sudoku
+{
+    // Constants
+    const int Grid::UNDEFINED_VALUE = 0;
+    const int Grid::MIN_VALUE = 1;
+    const int Grid::MAX_VALUE = 9;
+    const int Grid::NUM_ROWS = 9;
+    const int Grid::NUM_COLUMNS = 9;
+    const int Grid::SUBREGION_NUM_ROWS = 3;
+    const int Grid::SUBREGION_NUM_COLUMNS = 3;
+    const int Grid::NUM_CELLS;
+    const int Grid::NUM_UNITS;
+
+    const uint8_t Grid::UNIT_CELLS[NUM_UNITS][9] = {
+        // rows
+        {  0,  1,  2,  3,  4,  5,  6,  7,  8 },
+        {  9, 10, 11, 12, 13, 14, 15, 16, 17 },
+        { 18, 19, 20, 21, 22, 23, 24, 25, 26 },
+        { 27, 28, 29, 30, 31, 32, 33, 34, 35 },
+        { 36, 37, 38, 39, 40, 41, 42, 43, 44 },
+        { 45, 46, 47, 48, 49, 50, 51, 52, 53 },
+        { 54, 55, 56, 57, 58, 59, 60, 61, 62 },
+        { 63, 64, 65, 66, 67, 68, 69, 70, 71 },
+        { 72, 73, 74, 75, 76, 77, 78, 79, 80 },
+        // columns
+        {  0,  9, 18, 27, 36, 45, 54, 63, 72 },
+        {  1, 10, 19, 28, 37, 46, 55, 64, 73 },
+        {  2, 11, 20, 29, 38, 47, 56, 65, 74 },
+        {  3, 12, 21, 30, 39, 48, 57, 66, 75 },
+        {  4, 13, 22, 31, 40, 49, 58, 67, 76 },
+        {  5, 14, 23, 32, 41, 50, 59, 68, 77 },
+        {  6, 15, 24, 33, 42, 51, 60, 69, 78 },
+        {  7, 16, 25, 34, 43, 52, 61, 70, 79 },
+        {  8, 17, 26, 35, 44, 53, 62, 71, 80 },
+        // boxes
+        {  0,  1,  2,  9, 10, 11, 18, 19, 20 },
+        {  3,  4,  5, 12, 13, 14, 21, 22, 23 },
+        {  6,  7,  8, 15, 16, 17, 24, 25, 26 },
+        { 27, 28, 29, 36, 37, 38, 45, 46, 47 },
+        { 30, 31, 32, 39, 40, 41, 48, 49, 50 },
+        { 33, 34, 35, 42, 43, 44, 51, 52, 53 },
+        { 54, 55, 56, 63, 64, 65, 72, 73, 74 },
+        { 57, 58, 59, 66, 67, 68, 75, 76, 77 },
+        { 60, 61, 62, 69, 70, 71, 78, 79, 80 }
+    };
+
+
+    namespace
+    {
+        const uint16_t ALL_VALUES = 0x3fe;  // bits 1 to 9
+
+        const char* const UNIT_NAMES[3] = { "row", "column", "box" };
+    }
+
+
+    Grid::Grid()
+        : cells_(),
+          rows_(),
+          columns_(),
+          boxes_(),
+          repeated_(0)
+    {
+        cells_.fill(UNDEFINED_VALUE);
+    }
+
+
+    Grid::Grid(const Cells& cells)
+        : cells_(cells)
+    {
+        updateUnitValues();
+    }
+
+
+    Grid Grid::fromString(const std::string& str)
+    {
+        if (str.size() != static_cast<size_t>(NUM_CELLS)) {
+            std::ostringstream oss;
+            oss << "expected " << NUM_CELLS << " cells, found " << str.size();
+            throw std::invalid_argument(oss.str());
+        }
+
+        Grid grid;
+        for (int i = 0; i < NUM_CELLS; ++i) {
+            char c = str[i];
+            if (c >= '1' && c <= '9') {
+                grid.addValue(i / NUM_COLUMNS, i % NUM_COLUMNS, c - '0');
+            } else if (c != '.' && c != '0') {
+                std::ostringstream oss;
+                oss << "invalid cell '" << c << "'";
+                throw std::invalid_argument(oss.str());
+            }
+        }
+        return grid;
+    }
+
+
+    std::string Grid::toString() const
+    {
+        std::string str(NUM_CELLS, '.');
+        for (int i = 0; i < NUM_CELLS; ++i) {
+            if (cells_[i] != UNDEFINED_VALUE)
+                str[i] = static_cast<char>('0' + cells_[i]);
+        }
+        return str;
+    }
+
+
+    void Grid::setValue(int row, int column, int value)
+    {
+        if (row < 0 || row >= NUM_ROWS)
+            throw std::out_of_range("The row must be in the range[0, 9)");
+        if (column < 0 || column >= NUM_COLUMNS)
+            throw std::out_of_range("The column must be in the range [0, 9)");
+        if (value < MIN_VALUE || value > MAX_VALUE)
+            throw std::out_of_range(
+                "The grid cell value must be in the range [1, 9]");
+
+        setValueUnchecked(row, column, value);
+    }
+
+
+    int Grid::getValue(int row, int column) const
+    {
+        if (row < 0 || row >= NUM_ROWS)
+            throw std::out_of_range("The row must be in the range[0, 9)");
+        if (column < 0 || column >= NUM_COLUMNS)
+            throw std::out_of_range("The column must be in the range [0, 9)");
+
+        return getValueUnchecked(row, column);
+    }
+
+
+    bool Grid::conflicts(int row, int column, int value) const
+    {
+        if (row < 0 || row >= NUM_ROWS)
+            throw std::out_of_range("The row must be in the range[0, 9)");
+        if (column < 0 || column >= NUM_COLUMNS)
+            throw std::out_of_range("The column must be in the range [0, 9)");
+        if (value < MIN_VALUE || value > MAX_VALUE)
+            throw std::out_of_range(
+                "The grid cell value must be in the range [1, 9]");
+
+        Mask bit = static_cast<Mask>(1 << value);
+        int box = row / 3 * 3 + column / 3;
+        if (((rows_[row] | columns_[column] | boxes_[box]) & bit) == 0)
+            return false;
+        if (getValueUnchecked(row, column) != value)
+            return true;
+        if (repeated_ == 0)
+            return false;   // the value is the cell's own
+
+        // The cell has the value, look for another one
+        const uint8_t* units[3] = {
+            UNIT_CELLS[row], UNIT_CELLS[9 + column], UNIT_CELLS[18 + box]
+        };
+        int cell = row * NUM_COLUMNS + column;
+        for (int u = 0; u < 3; ++u) {
+            for (int i = 0; i < 9; ++i) {
+                if (units[u][i] != cell && cells_[units[u][i]] == value)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+
+    bool Grid::isValid() const
+    {
+        return check(NULL);
+    }
+
+
+    void Grid::validate() const
+    {
+        std::string reason;
+        if (!check(&reason))
+            throw std::invalid_argument(reason);
+    }
+
+
+    bool Grid::operator==(const Grid& other) const
+    {
+        return ::memcmp(cells_.data(), other.cells_.data(), NUM_CELLS) == 0;
+    }
+
+
+    bool Grid::operator!=(const Grid& other) const
+    {
+        return !(*this == other);
+    }
+
+
+    //
+    // Private
+    //
+    void Grid::updateUnitValues()
+    {
+        Cells cells = cells_;
+        ::memset(rows_, 0, sizeof(rows_));
+        ::memset(columns_, 0, sizeof(columns_));
+        ::memset(boxes_, 0, sizeof(boxes_));
+        repeated_ = 0;
+
+        for (int i = 0; i < NUM_CELLS; ++i) {
+            if (cells[i] != UNDEFINED_VALUE)
+                addValue(i / NUM_COLUMNS, i % NUM_COLUMNS, cells[i]);
+        }
+    }
+
+
+    bool Grid::check(std::string* reason) const
+    {
+        if (repeated_ > 0) {
+            for (int unit = 0; unit < NUM_UNITS; ++unit) {
+                Mask seen = 0;
+                for (int i = 0; i < 9; ++i) {
+                    int value = cells_[UNIT_CELLS[unit][i]];
+                    Mask bit = static_cast<Mask>(1 << value);
+                    if (value == UNDEFINED_VALUE)
+                        continue;
+                    if ((seen & bit) == 0) {
+                        seen |= bit;
+                        continue;
+                    }
+
+                    if (reason != NULL) {
+                        std::ostringstream oss;
+                        oss << "value " << value << " repeated in "
+                            << UNIT_NAMES[unit / 9] << " " << unit % 9 + 1;
+                        *reason = oss.str();
+                    }
+                    return false;
+                }
+            }
+        }
+
+        // Values that still fit in every empty cell
+        Mask fits[NUM_CELLS];
+        for (int row = 0; row < NUM_ROWS; ++row) {
+            for (int column = 0; column < NUM_COLUMNS; ++column) {
+                int cell = row * NUM_COLUMNS + column;
+                fits[cell] = 0;
+                if (cells_[cell] != UNDEFINED_VALUE)
+                    continue;
+
+                Mask used = rows_[row] | columns_[column] |
+                            boxes_[row / 3 * 3 + column / 3];
+                fits[cell] = static_cast<Mask>(ALL_VALUES & ~used);
+                if (fits[cell] == 0) {
+                    if (reason != NULL) {
+                        std::ostringstream oss;
+                        oss << "no value fits in cell (" << row + 1 << ", "
+                            << column + 1 << ")";
+                        *reason = oss.str();
+                    }
+                    return false;
+                }
+            }
+        }
+
+        const Mask* unit_values[3] = { rows_, columns_, boxes_ };
+        for (int unit = 0; unit < NUM_UNITS; ++unit) {
+            Mask placeable = unit_values[unit / 9][unit % 9];
+            for (int i = 0; i < 9; ++i)
+                placeable |= fits[UNIT_CELLS[unit][i]];
+            if (placeable == ALL_VALUES)
+                continue;
+
+            if (reason != NULL) {
+                int value = __builtin_ctz(ALL_VALUES & ~placeable);
+                std::ostringstream oss;
+                oss << "value " << value << " fits nowhere in "
+                    << UNIT_NAMES[unit / 9] << " " << unit % 9 + 1;
+                *reason = oss.str();
+            }
+            return false;
+        }
+        return true;
+    }
+
+}
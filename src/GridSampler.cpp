@@ -0,0 +1,173 @@
+//
+// File: GridSampler.cpp
+//
+
+#include <cstring>
+
+#include <stdexcept>
+
+#include "GridSampler.hpp"
+#include "Symmetry.hpp"
+
+
+namespace sudoku
+{
+    namespace
+    {
+        const unsigned ALL_VALUES = 0x3fe;  // bits 1 to 9
+
+        inline int boxOf(int row, int column)
+        {
+            return row / 3 * 3 + column / 3;
+        }
+    }
+
+
+    GridSampler::GridSampler(unsigned long seed, Method method,
+                             SolverPool& pool)
+        : pool_(pool),
+          method_(method),
+          shuffle_(false),
+          random_(static_cast<std::mt19937::result_type>(seed)),
+          stats_()
+    { }
+
+
+    GridSampler::~GridSampler()
+    { }
+
+
+    void GridSampler::setShuffle(bool shuffle)
+    {
+        shuffle_ = shuffle;
+    }
+
+
+    void GridSampler::sample(Grid& grid)
+    {
+        if (method_ == SAT)
+            sampleBySat(grid);
+        else
+            sampleBySearch(grid);
+
+        if (shuffle_)
+            grid = Transform::random(random_).apply(grid);
+        stats_.grids += 1;
+    }
+
+
+    const GridSampler::Stats& GridSampler::stats() const
+    {
+        return stats_;
+    }
+
+
+    //
+    // Private
+    //
+    void GridSampler::sampleBySearch(Grid& grid)
+    {
+        ::memset(cells_, 0, sizeof(cells_));
+        ::memset(rows_, 0, sizeof(rows_));
+        ::memset(columns_, 0, sizeof(columns_));
+        ::memset(boxes_, 0, sizeof(boxes_));
+
+        // The empty grid always has a solution
+        fill(0);
+
+        Grid::Cells cells;
+        ::memcpy(cells.data(), cells_, Grid::NUM_CELLS);
+        grid = Grid(cells);
+    }
+
+
+    void GridSampler::sampleBySat(Grid& grid)
+    {
+        // A solver over the memory budget of the pool is rebuilt when its
+        // lease ends, so the second one only fails if the budget is too
+        // small for the empty grid
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            SolverPool::Lease solver(pool_);
+
+            // One value in nine is true, so are the phases
+            for (int literal = 1; literal <= SudokuSolver::NUM_LITERALS;
+                 ++literal) {
+                solver->setDefaultPhase(literal,
+                                        random_() % 9 == 0 ? 1 : -1);
+            }
+
+            Solver::SOLVE_RESULT res = solver->solve(-1);
+            if (res == Solver::SATISFIABLE) {
+                solver->readModel(model_, SudokuSolver::NUM_LITERALS);
+                SudokuSolver::decodeModel(model_, grid);
+            }
+
+            // Other leases get the default heuristic back
+            solver->resetPhases();
+            if (res == Solver::SATISFIABLE)
+                return;
+        }
+        throw std::runtime_error("the solver ran out of memory filling a "
+                                 "grid");
+    }
+
+
+    bool GridSampler::fill(int filled)
+    {
+        if (filled == Grid::NUM_CELLS)
+            return true;
+
+        // The empty cell with the fewest candidates
+        int cell = -1;
+        unsigned candidates = 0;
+        int min_count = 10;
+        for (int i = 0; i < Grid::NUM_CELLS && min_count > 1; ++i) {
+            if (cells_[i] != 0)
+                continue;
+            int row = i / 9, column = i % 9;
+            unsigned mask = ALL_VALUES & ~(rows_[row] | columns_[column] |
+                                           boxes_[boxOf(row, column)]);
+            int count = __builtin_popcount(mask);
+            if (count < min_count) {
+                cell = i;
+                candidates = mask;
+                min_count = count;
+            }
+        }
+        if (min_count == 0)
+            return false;
+
+        uint8_t values[9];
+        int num_values = 0;
+        for (int v = 1; v <= 9; ++v) {
+            if (candidates & (1u << v))
+                values[num_values++] = static_cast<uint8_t>(v);
+        }
+        for (int k = num_values - 1; k > 0; --k) {
+            int other = static_cast<int>(random_() % (k + 1));
+            uint8_t tmp = values[k];
+            values[k] = values[other];
+            values[other] = tmp;
+        }
+
+        int row = cell / 9, column = cell % 9, box = boxOf(row, column);
+        for (int k = 0; k < num_values; ++k) {
+            uint16_t bit = static_cast<uint16_t>(1u << values[k]);
+            cells_[cell] = values[k];
+            rows_[row] |= bit;
+            columns_[column] |= bit;
+            boxes_[box] |= bit;
+
+            if (fill(filled + 1))
+                return true;
+
+            cells_[cell] = 0;
+            rows_[row] &= static_cast<uint16_t>(~bit);
+            columns_[column] &= static_cast<uint16_t>(~bit);
+            boxes_[box] &= static_cast<uint16_t>(~bit);
+            stats_.backtracks += 1;
+        }
+        return false;
+    }
+
+}
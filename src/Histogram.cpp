@@ -0,0 +1,157 @@
+//
+// File: Histogram.cpp
+//
+
+#include <cmath>
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+#include "Histogram.hpp"
+
+
+namespace sudoku
+{
+    // Width of the largest bar
+    static const int MAX_BAR_WIDTH = 40;
+
+    const int Histogram::NUM_BUCKETS;
+
+    Histogram::Histogram()
+        : count_(0),
+          total_(0),
+          min_(0),
+          max_(0)
+    {
+        std::fill(buckets_, buckets_ + NUM_BUCKETS, 0);
+    }
+
+
+    void Histogram::add(double seconds)
+    {
+        buckets_[bucketFor(seconds)] += 1;
+
+        if (count_ == 0 || seconds < min_)
+            min_ = seconds;
+        if (count_ == 0 || seconds > max_)
+            max_ = seconds;
+        total_ += seconds;
+        count_ += 1;
+    }
+
+
+    size_t Histogram::count() const
+    {
+        return count_;
+    }
+
+
+    double Histogram::total() const
+    {
+        return total_;
+    }
+
+
+    double Histogram::min() const
+    {
+        return min_;
+    }
+
+
+    double Histogram::max() const
+    {
+        return max_;
+    }
+
+
+    double Histogram::mean() const
+    {
+        return count_ > 0 ? total_ / count_ : 0;
+    }
+
+
+    double Histogram::percentile(double p) const
+    {
+        if (count_ == 0)
+            return 0;
+
+        size_t rank = static_cast<size_t>(std::ceil(p * count_));
+        size_t seen = 0;
+        for (int i = 0; i < NUM_BUCKETS; ++i) {
+            seen += buckets_[i];
+            if (seen >= rank && seen > 0)
+                return std::min(bucketLimit(i) * 1e-6, max_);
+        }
+        return max_;
+    }
+
+
+    void Histogram::print(std::ostream& os, const std::string& name) const
+    {
+        // The format is restored before returning, the caller keeps its own
+        std::ios_base::fmtflags flags = os.flags();
+        std::streamsize precision = os.precision();
+
+        os << std::fixed << std::setprecision(1)
+           << name << ": " << count_ << " samples, mean " << mean() * 1e6
+           << " us, p50 <= " << percentile(0.50) * 1e6
+           << " us, p99 <= " << percentile(0.99) * 1e6
+           << " us, max " << max_ * 1e6 << " us" << std::endl;
+
+        if (count_ != 0)
+            printBuckets(os);
+
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+
+    void Histogram::printBuckets(std::ostream& os) const
+    {
+        int first = 0, last = NUM_BUCKETS - 1;
+        while (buckets_[first] == 0)
+            ++first;
+        while (buckets_[last] == 0)
+            --last;
+
+        size_t highest = *std::max_element(buckets_, buckets_ + NUM_BUCKETS);
+        for (int i = first; i <= last; ++i) {
+            double low = (i == 0) ? 0 : bucketLimit(i - 1);
+            int width = static_cast<int>(
+                (buckets_[i] * MAX_BAR_WIDTH + highest - 1) / highest);
+
+            os << "  [" << std::setw(9) << std::setprecision(0) << low << ", ";
+            if (i + 1 < NUM_BUCKETS)
+                os << std::setw(9) << bucketLimit(i) << ") us ";
+            else
+                os << "      inf) us ";
+            os << std::setw(9) << buckets_[i] << " "
+               << std::string(width, '#') << std::endl;
+        }
+    }
+
+
+    // ------------------------------------------------------------------------
+    // Private functions
+
+    int Histogram::bucketFor(double seconds)
+    {
+        double us = seconds * 1e6;
+        if (us < 1)
+            return 0;
+
+        // us = m * 2^exponent with m in [0.5, 1), so us is in the bucket
+        // [2^(exponent - 1), 2^exponent)
+        int exponent;
+        std::frexp(us, &exponent);
+        return std::min(exponent, NUM_BUCKETS - 1);
+    }
+
+
+    double Histogram::bucketLimit(int bucket)
+    {
+        return std::ldexp(1.0, bucket);
+    }
+
+}
@@ -0,0 +1,139 @@
+//
+// File: PuzzleGenerator.cpp
+//
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "PuzzleGenerator.hpp"
+
+
+namespace sudoku
+{
+    PuzzleGenerator::Filter PuzzleGenerator::anyPuzzle()
+    {
+        Filter filter;
+        filter.min_clues = 0;
+        filter.max_clues = Grid::NUM_CELLS;
+        filter.min_decisions = 0;
+        filter.max_decisions = std::numeric_limits<size_t>::max();
+        filter.min_rating = 0;
+        filter.max_rating = std::numeric_limits<double>::max();
+        return filter;
+    }
+
+
+    PuzzleGenerator::PuzzleGenerator(unsigned long seed, SolverPool& pool)
+        : pool_(pool),
+          engine_(pool),
+          rater_(),
+          random_(static_cast<std::mt19937::result_type>(seed)),
+          sampler_(random_(), GridSampler::SEARCH, pool),
+          stats_()
+    { }
+
+
+    PuzzleGenerator::~PuzzleGenerator()
+    { }
+
+
+    void PuzzleGenerator::generate(const Filter& filter, Grid& puzzle,
+                                   Grid& solution)
+    {
+        while (true) {
+            sampler_.sample(solution);
+            stats_.grids += 1;
+            removeClues(solution, puzzle);
+            if (accepts(filter, puzzle))
+                return;
+            stats_.rejected += 1;
+        }
+    }
+
+
+    void PuzzleGenerator::removeClues(const Grid& solution, Grid& puzzle)
+    {
+        SolverPool::Lease solver(pool_);
+
+        // Rules out the solution while the context is open
+        std::vector<int> other_solution;
+        other_solution.reserve(Grid::NUM_CELLS);
+        for (int i = 0; i < Grid::NUM_ROWS; ++i) {
+            for (int j = 0; j < Grid::NUM_COLUMNS; ++j) {
+                other_solution.push_back(
+                    -SudokuSolver::getLiteralForRowColumnValue(
+                        i, j, solution.getValueUnchecked(i, j)));
+            }
+        }
+        solver->push();
+        solver->addClause(other_solution);
+
+        uint8_t cells[Grid::NUM_CELLS];
+        for (int i = 0; i < Grid::NUM_CELLS; ++i)
+            cells[i] = static_cast<uint8_t>(i);
+        std::shuffle(cells, cells + Grid::NUM_CELLS, random_);
+
+        puzzle = solution;
+        for (int k = 0; k < Grid::NUM_CELLS; ++k) {
+            int row = cells[k] / Grid::NUM_COLUMNS;
+            int column = cells[k] % Grid::NUM_COLUMNS;
+            puzzle.setValueUnchecked(row, column, Grid::UNDEFINED_VALUE);
+
+            for (int i = 0; i < Grid::NUM_ROWS; ++i) {
+                for (int j = 0; j < Grid::NUM_COLUMNS; ++j) {
+                    int value = puzzle.getValueUnchecked(i, j);
+                    if (value != Grid::UNDEFINED_VALUE)
+                        solver->assume(SudokuSolver::
+                            getLiteralForRowColumnValue(i, j, value));
+                }
+            }
+
+            stats_.checks += 1;
+            if (solver->solve(-1) != Solver::UNSATISFIABLE)
+                puzzle.setValueUnchecked(row, column,
+                                         solution.getValueUnchecked(row,
+                                                                    column));
+        }
+
+        solver->pop();
+    }
+
+
+    const PuzzleGenerator::Stats& PuzzleGenerator::stats() const
+    {
+        return stats_;
+    }
+
+
+    //
+    // Private
+    //
+    bool PuzzleGenerator::accepts(const Filter& filter, const Grid& puzzle)
+    {
+        int clues = 0;
+        const Grid::Cells& cells = puzzle.getCells();
+        for (int i = 0; i < Grid::NUM_CELLS; ++i)
+            clues += (cells[i] != Grid::UNDEFINED_VALUE) ? 1 : 0;
+        if (clues < filter.min_clues || clues > filter.max_clues)
+            return false;
+
+        if (filter.min_rating > 0 ||
+            filter.max_rating < std::numeric_limits<double>::max()) {
+            double score = rater_.rate(puzzle).score;
+            if (score < filter.min_rating || score > filter.max_rating)
+                return false;
+        }
+
+        if (filter.min_decisions == 0 &&
+            filter.max_decisions == std::numeric_limits<size_t>::max())
+            return true;
+
+        Grid solution;
+        engine_.solve(puzzle, solution);
+        unsigned long long decisions = engine_.getSolverStats().decisions;
+        return decisions >= filter.min_decisions &&
+               decisions <= filter.max_decisions;
+    }
+
+}
@@ -0,0 +1,690 @@
+//
+// File: PuzzleRater.cpp
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "PuzzleRater.hpp"
+
+
+namespace sudoku
+{
+    namespace
+    {
+        typedef CandidateGrid::Mask Mask;
+
+        const char* const TECHNIQUE_NAMES[PuzzleRater::NUM_TECHNIQUES] = {
+            "Hidden single (box)",
+            "Hidden single (line)",
+            "Naked single",
+            "Pointing",
+            "Claiming",
+            "Naked pair",
+            "X-Wing",
+            "Hidden pair",
+            "Naked triple",
+            "Swordfish",
+            "Hidden triple",
+            "XY-Wing",
+            "XYZ-Wing",
+            "Naked quad",
+            "Jellyfish",
+            "Hidden quad",
+            "Forcing chain",
+            "Trial and error"
+        };
+
+        // As Sudoku Explainer rates them
+        const double TECHNIQUE_SCORES[PuzzleRater::NUM_TECHNIQUES] = {
+            1.2, 1.5, 2.3, 2.6, 2.8, 3.0, 3.2, 3.4, 3.6, 3.8, 4.0, 4.2, 4.4,
+            5.0, 5.2, 5.4, 7.0, 10.0
+        };
+
+        // Masks of 9 bits with 2, 3 and 4 bits set, the subsets tried
+        struct Combinations
+        {
+            Mask masks[5][126];
+            int counts[5];
+
+            Combinations()
+                : masks(), counts()
+            {
+                for (unsigned mask = 0; mask < 512; ++mask) {
+                    int k = __builtin_popcount(mask);
+                    if (k >= 2 && k <= 4)
+                        masks[k][counts[k]++] = static_cast<Mask>(mask);
+                }
+            }
+        };
+
+        const Combinations COMBINATIONS;
+
+        inline int countBits(unsigned mask)
+        {
+            return __builtin_popcount(mask);
+        }
+
+        inline int firstBit(unsigned mask)
+        {
+            return __builtin_ctz(mask);
+        }
+
+        // Items, bits 0 to 8, with 2 to size bits in their masks
+        Mask eligibleItems(const Mask masks[9], int size)
+        {
+            Mask eligible = 0;
+            for (int i = 0; i < 9; ++i) {
+                int count = countBits(masks[i]);
+                if (count >= 2 && count <= size)
+                    eligible |= static_cast<Mask>(1 << i);
+            }
+            return eligible;
+        }
+
+        Mask coverOf(const Mask masks[9], Mask items)
+        {
+            Mask cover = 0;
+            for (; items != 0; items &= static_cast<Mask>(items - 1))
+                cover |= masks[firstBit(items)];
+            return cover;
+        }
+
+        /**
+         * Returns the values that are a candidate of a single cell of the
+         * unit and sets seen to the ones that are a candidate of any,
+         * counting the candidates of all the cells at once.
+         */
+        Mask uniqueValues(const CandidateGrid& grid, int unit, Mask& seen)
+        {
+            const uint8_t* cells = Grid::UNIT_CELLS[unit];
+            Mask once = 0;
+            Mask twice = 0;
+            for (int i = 0; i < 9; ++i) {
+                Mask candidates = grid.candidates(cells[i]);
+                twice |= once & candidates;
+                once |= candidates;
+            }
+            seen = once;
+            return once & static_cast<Mask>(~twice);
+        }
+
+        // Cell of the unit with the candidate, which must have one
+        int cellWith(const CandidateGrid& grid, int unit, int value)
+        {
+            return Grid::UNIT_CELLS[unit]
+                                   [firstBit(grid.positions(unit, value))];
+        }
+
+        // Extra score of a chain, 0.1 every time its length goes past 4,
+        // 6, 8, 12, 16, 24 ... as Sudoku Explainer does
+        double lengthScore(int length)
+        {
+            double score = 0;
+            int limit = 4;
+            bool odd = false;
+            while (length > limit) {
+                score += 0.1;
+                limit = odd ? limit * 4 / 3 : limit * 3 / 2;
+                odd = !odd;
+            }
+            return score;
+        }
+
+        /**
+         * Places the naked and hidden singles of the grid until one
+         * contradicts another. Returns the values placed up to the
+         * contradiction or -1 if there is none before placing limit.
+         */
+        int propagateSingles(CandidateGrid& grid, int limit)
+        {
+            int placed = 0;
+            bool progress = true;
+            while (progress) {
+                progress = false;
+
+                for (int cell = 0; cell < Grid::NUM_CELLS; ++cell) {
+                    if (grid.value(cell) != Grid::UNDEFINED_VALUE)
+                        continue;
+                    Mask candidates = grid.candidates(cell);
+                    if (candidates == 0)
+                        return placed;
+                    if (countBits(candidates) == 1) {
+                        grid.place(cell, firstBit(candidates));
+                        if (++placed >= limit)
+                            return -1;
+                        progress = true;
+                    }
+                }
+
+                for (int unit = 0; unit < Grid::NUM_UNITS; ++unit) {
+                    Mask seen;
+                    Mask unique = uniqueValues(grid, unit, seen);
+                    if ((seen | grid.placed(unit)) !=
+                        CandidateGrid::ALL_VALUES)
+                        return placed;
+                    for (; unique != 0;
+                         unique &= static_cast<Mask>(unique - 1)) {
+                        // Gone if its cell took another unique value
+                        int value = firstBit(unique);
+                        Mask positions = grid.positions(unit, value);
+                        if (positions == 0)
+                            return placed;
+                        grid.place(Grid::UNIT_CELLS[unit][firstBit(positions)],
+                                   value);
+                        if (++placed >= limit)
+                            return -1;
+                        progress = true;
+                    }
+                }
+            }
+            return -1;
+        }
+    }
+
+
+    const char* PuzzleRater::techniqueName(Technique technique)
+    {
+        return TECHNIQUE_NAMES[technique];
+    }
+
+
+    double PuzzleRater::techniqueScore(Technique technique)
+    {
+        return TECHNIQUE_SCORES[technique];
+    }
+
+
+    PuzzleRater::PuzzleRater()
+        : grid_(),
+          trial_(),
+          hint_cached_(false),
+          hint_puzzle_(),
+          hint_step_()
+    { }
+
+
+    PuzzleRater::~PuzzleRater()
+    { }
+
+
+    PuzzleRater::Rating PuzzleRater::rate(const Grid& puzzle)
+    {
+        Rating rating;
+        rating.score = 0;
+        rating.hardest = HIDDEN_SINGLE_BOX;
+        hint_cached_ = false;
+        rating.valid = grid_.reset(puzzle);
+        rating.solved = false;
+        rating.steps = 0;
+
+        while (rating.valid && grid_.unsolved() > 0) {
+            if (!grid_.isConsistent()) {
+                rating.valid = false;
+                break;
+            }
+
+            Technique technique;
+            double score;
+            bool progress = step(FORCING_CHAIN, technique, score);
+            if (!progress) {
+                technique = TRIAL_AND_ERROR;
+                score = techniqueScore(TRIAL_AND_ERROR);
+            }
+
+            if (score > rating.score) {
+                rating.score = score;
+                rating.hardest = technique;
+            }
+            if (!progress)
+                return rating;
+            rating.steps += 1;
+        }
+
+        rating.solved = rating.valid;
+        return rating;
+    }
+
+
+    PuzzleRater::Hint PuzzleRater::hint(const Grid& grid, Technique hardest)
+    {
+        Hint hint;
+        hint.row = -1;
+        hint.column = -1;
+        hint.value = Grid::UNDEFINED_VALUE;
+        hint.technique = HIDDEN_SINGLE_BOX;
+
+        bool valid = extendHintGrid(grid);
+        while (valid && grid_.unsolved() > 0 && grid_.isConsistent()) {
+            // The placed value is not kept, the next grid may not have it
+            hint_step_ = grid_;
+            Technique technique;
+            double score;
+            if (!step(hardest, technique, score))
+                break;
+            hint.technique = std::max(hint.technique, technique);
+            if (grid_.unsolved() == hint_step_.unsolved())
+                continue;
+
+            for (int cell = 0; cell < Grid::NUM_CELLS; ++cell) {
+                if (grid_.value(cell) != hint_step_.value(cell)) {
+                    hint.row = cell / Grid::NUM_COLUMNS;
+                    hint.column = cell % Grid::NUM_COLUMNS;
+                    hint.value = grid_.value(cell);
+                    break;
+                }
+            }
+            grid_ = hint_step_;
+            break;
+        }
+        return hint;
+    }
+
+
+    //
+    // Private
+    //
+    bool PuzzleRater::step(Technique hardest, Technique& technique,
+                           double& score)
+    {
+        for (int i = 0; i <= hardest && i < TRIAL_AND_ERROR; ++i) {
+            technique = static_cast<Technique>(i);
+            score = techniqueScore(technique);
+            if (apply(technique, score))
+                return true;
+        }
+        return false;
+    }
+
+
+    bool PuzzleRater::apply(Technique technique, double& score)
+    {
+        switch (technique) {
+            case HIDDEN_SINGLE_BOX:
+                return findHiddenSingle(18, 27);
+            case HIDDEN_SINGLE_LINE:
+                return findHiddenSingle(0, 18);
+            case NAKED_SINGLE:
+                return findNakedSingle();
+            case POINTING:
+                return findPointing();
+            case CLAIMING:
+                return findClaiming();
+            case NAKED_PAIR:
+                return findNakedSubset(2);
+            case X_WING:
+                return findFish(2);
+            case HIDDEN_PAIR:
+                return findHiddenSubset(2);
+            case NAKED_TRIPLE:
+                return findNakedSubset(3);
+            case SWORDFISH:
+                return findFish(3);
+            case HIDDEN_TRIPLE:
+                return findHiddenSubset(3);
+            case XY_WING:
+                return findXYWing();
+            case XYZ_WING:
+                return findXYZWing();
+            case NAKED_QUAD:
+                return findNakedSubset(4);
+            case JELLYFISH:
+                return findFish(4);
+            case HIDDEN_QUAD:
+                return findHiddenSubset(4);
+            case FORCING_CHAIN:
+                return findForcingChain(score);
+            default:
+                return false;
+        }
+    }
+
+
+    bool PuzzleRater::extendHintGrid(const Grid& grid)
+    {
+        // Candidates removed from a grid stay removed when values are
+        // added, unless the added values contradict them
+        const Grid::Cells& cells = grid.getCells();
+        const Grid::Cells& previous = hint_puzzle_.getCells();
+        bool extends = hint_cached_;
+        for (int i = 0; i < Grid::NUM_CELLS && extends; ++i) {
+            if (previous[i] != Grid::UNDEFINED_VALUE)
+                extends = cells[i] == previous[i];
+        }
+
+        for (int i = 0; i < Grid::NUM_CELLS && extends; ++i) {
+            if (previous[i] != Grid::UNDEFINED_VALUE ||
+                cells[i] == Grid::UNDEFINED_VALUE)
+                continue;
+            if (grid_.candidates(i) & (1 << cells[i]))
+                grid_.place(i, cells[i]);
+            else
+                extends = false;
+        }
+
+        hint_puzzle_ = grid;
+        hint_cached_ = extends || grid_.reset(grid);
+        return hint_cached_;
+    }
+
+
+    bool PuzzleRater::findHiddenSingle(int first_unit, int last_unit)
+    {
+        for (int unit = first_unit; unit < last_unit; ++unit) {
+            Mask seen;
+            Mask unique = uniqueValues(grid_, unit, seen);
+            if (unique != 0) {
+                int value = firstBit(unique);
+                grid_.place(cellWith(grid_, unit, value), value);
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    bool PuzzleRater::findNakedSingle()
+    {
+        for (int cell = 0; cell < Grid::NUM_CELLS; ++cell) {
+            Mask candidates = grid_.candidates(cell);
+            if (candidates != 0 && countBits(candidates) == 1) {
+                grid_.place(cell, firstBit(candidates));
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    bool PuzzleRater::findPointing()
+    {
+        // A value of a box only in one of its rows or columns is not in
+        // the rest of that line
+        for (int box = 0; box < 9; ++box) {
+            int unit = 18 + box;
+            Mask missing = CandidateGrid::ALL_VALUES &
+                           static_cast<Mask>(~grid_.placed(unit));
+            for (; missing != 0; missing &= static_cast<Mask>(missing - 1)) {
+                int value = firstBit(missing);
+                Mask positions = grid_.positions(unit, value);
+
+                for (int k = 0; k < 3; ++k) {
+                    int line;
+                    if ((positions & ~(0x7 << (3 * k))) == 0)
+                        line = box / 3 * 3 + k;
+                    else if ((positions & ~(0x49 << k)) == 0)
+                        line = 9 + box % 3 * 3 + k;
+                    else
+                        continue;
+
+                    bool changed = false;
+                    for (int i = 0; i < 9; ++i) {
+                        int cell = Grid::UNIT_CELLS[line][i];
+                        if (CandidateGrid::units(cell)[2] != unit)
+                            changed |= grid_.eliminate(cell, value);
+                    }
+                    if (changed)
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+
+
+    bool PuzzleRater::findClaiming()
+    {
+        // A value of a line only in one box is not in the rest of the box
+        for (int line = 0; line < 18; ++line) {
+            int kind = line < 9 ? 0 : 1;
+            Mask missing = CandidateGrid::ALL_VALUES &
+                           static_cast<Mask>(~grid_.placed(line));
+            for (; missing != 0; missing &= static_cast<Mask>(missing - 1)) {
+                int value = firstBit(missing);
+                Mask positions = grid_.positions(line, value);
+
+                for (int k = 0; k < 3; ++k) {
+                    if ((positions & ~(0x7 << (3 * k))) != 0)
+                        continue;
+
+                    int cell = Grid::UNIT_CELLS[line][3 * k];
+                    int box = CandidateGrid::units(cell)[2];
+                    bool changed = false;
+                    for (int i = 0; i < 9; ++i) {
+                        cell = Grid::UNIT_CELLS[box][i];
+                        if (CandidateGrid::units(cell)[kind] != line)
+                            changed |= grid_.eliminate(cell, value);
+                    }
+                    if (changed)
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+
+
+    bool PuzzleRater::findNakedSubset(int size)
+    {
+        // size cells of a unit with only size candidates between them
+        Mask masks[9];
+        for (int unit = 0; unit < Grid::NUM_UNITS; ++unit) {
+            const uint8_t* cells = Grid::UNIT_CELLS[unit];
+            for (int i = 0; i < 9; ++i)
+                masks[i] = grid_.candidates(cells[i]);
+
+            Mask eligible = eligibleItems(masks, size);
+            for (int k = 0; k < COMBINATIONS.counts[size]; ++k) {
+                Mask items = COMBINATIONS.masks[size][k];
+                if ((items & ~eligible) != 0)
+                    continue;
+                Mask values = coverOf(masks, items);
+                if (countBits(values) != size)
+                    continue;
+
+                bool changed = false;
+                for (int i = 0; i < 9; ++i) {
+                    if ((items & (1 << i)) || (masks[i] & values) == 0)
+                        continue;
+                    for (Mask v = values; v != 0;
+                         v &= static_cast<Mask>(v - 1))
+                        changed |= grid_.eliminate(cells[i], firstBit(v));
+                }
+                if (changed)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+
+    bool PuzzleRater::findHiddenSubset(int size)
+    {
+        // size values of a unit only in size cells between them
+        Mask masks[9];
+        for (int unit = 0; unit < Grid::NUM_UNITS; ++unit) {
+            const uint8_t* cells = Grid::UNIT_CELLS[unit];
+            for (int i = 0; i < 9; ++i)
+                masks[i] = grid_.positions(unit, i + 1);
+
+            Mask eligible = eligibleItems(masks, size);
+            for (int k = 0; k < COMBINATIONS.counts[size]; ++k) {
+                Mask items = COMBINATIONS.masks[size][k];
+                if ((items & ~eligible) != 0)
+                    continue;
+                Mask positions = coverOf(masks, items);
+                if (countBits(positions) != size)
+                    continue;
+
+                Mask others = CandidateGrid::ALL_VALUES &
+                              static_cast<Mask>(~(items << 1));
+                bool changed = false;
+                for (Mask p = positions; p != 0;
+                     p &= static_cast<Mask>(p - 1)) {
+                    int cell = cells[firstBit(p)];
+                    for (Mask v = grid_.candidates(cell) & others; v != 0;
+                         v &= static_cast<Mask>(v - 1))
+                        changed |= grid_.eliminate(cell, firstBit(v));
+                }
+                if (changed)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+
+    bool PuzzleRater::findFish(int size)
+    {
+        // A value only in the same size columns of size rows is in none
+        // of the other rows of those columns, and the other way around
+        Mask masks[9];
+        for (int value = 1; value <= 9; ++value) {
+            for (int base = 0; base < 18; base += 9) {
+                int cover = 9 - base;
+                for (int i = 0; i < 9; ++i)
+                    masks[i] = grid_.positions(base + i, value);
+
+                Mask eligible = eligibleItems(masks, size);
+                for (int k = 0; k < COMBINATIONS.counts[size]; ++k) {
+                    Mask items = COMBINATIONS.masks[size][k];
+                    if ((items & ~eligible) != 0)
+                        continue;
+                    Mask lines = coverOf(masks, items);
+                    if (countBits(lines) != size)
+                        continue;
+
+                    bool changed = false;
+                    for (Mask l = lines; l != 0;
+                         l &= static_cast<Mask>(l - 1)) {
+                        const uint8_t* cells =
+                            Grid::UNIT_CELLS[cover + firstBit(l)];
+                        for (int i = 0; i < 9; ++i) {
+                            if ((items & (1 << i)) == 0)
+                                changed |= grid_.eliminate(cells[i], value);
+                        }
+                    }
+                    if (changed)
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+
+
+    bool PuzzleRater::findXYWing()
+    {
+        // A pivot xy sees the pincers xz and yz, one of them is z
+        for (int pivot = 0; pivot < Grid::NUM_CELLS; ++pivot) {
+            Mask xy = grid_.candidates(pivot);
+            if (countBits(xy) != 2)
+                continue;
+
+            const uint8_t* peers = CandidateGrid::peers(pivot);
+            for (int i = 0; i < CandidateGrid::NUM_PEERS; ++i) {
+                int pincer1 = peers[i];
+                Mask xz = grid_.candidates(pincer1);
+                if (countBits(xz) != 2 || countBits(xz & xy) != 1)
+                    continue;
+                Mask z = xz & static_cast<Mask>(~xy);
+                Mask yz = (xy & static_cast<Mask>(~xz)) | z;
+
+                for (int j = 0; j < CandidateGrid::NUM_PEERS; ++j) {
+                    int pincer2 = peers[j];
+                    if (grid_.candidates(pincer2) != yz)
+                        continue;
+
+                    bool changed = false;
+                    const uint8_t* targets = CandidateGrid::peers(pincer1);
+                    for (int t = 0; t < CandidateGrid::NUM_PEERS; ++t) {
+                        if (CandidateGrid::sees(targets[t], pincer2))
+                            changed |= grid_.eliminate(targets[t],
+                                                       firstBit(z));
+                    }
+                    if (changed)
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+
+
+    bool PuzzleRater::findXYZWing()
+    {
+        // A pivot xyz sees the pincers xz and yz, one of the three is z
+        for (int pivot = 0; pivot < Grid::NUM_CELLS; ++pivot) {
+            Mask xyz = grid_.candidates(pivot);
+            if (countBits(xyz) != 3)
+                continue;
+
+            const uint8_t* peers = CandidateGrid::peers(pivot);
+            for (int i = 0; i < CandidateGrid::NUM_PEERS; ++i) {
+                int pincer1 = peers[i];
+                Mask xz = grid_.candidates(pincer1);
+                if (countBits(xz) != 2 || (xz & ~xyz) != 0)
+                    continue;
+
+                for (int j = i + 1; j < CandidateGrid::NUM_PEERS; ++j) {
+                    int pincer2 = peers[j];
+                    Mask yz = grid_.candidates(pincer2);
+                    if (countBits(yz) != 2 || (xz | yz) != xyz)
+                        continue;
+
+                    int z = firstBit(xz & yz);
+                    bool changed = false;
+                    for (int t = 0; t < CandidateGrid::NUM_PEERS; ++t) {
+                        int target = peers[t];
+                        if (CandidateGrid::sees(target, pincer1) &&
+                            CandidateGrid::sees(target, pincer2))
+                            changed |= grid_.eliminate(target, z);
+                    }
+                    if (changed)
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+
+
+    bool PuzzleRater::findForcingChain(double& score)
+    {
+        // The candidate whose assumption contradicts itself soonest. Cells
+        // with few candidates usually lead to short chains, trying them
+        // first bounds the propagation of the rest sooner.
+        int best_length = Grid::NUM_CELLS + 1;
+        int best_cell = -1;
+        int best_value = 0;
+        for (int count = 2; count <= 9 && best_length > 0; ++count) {
+            for (int cell = 0; cell < Grid::NUM_CELLS; ++cell) {
+                Mask candidates = grid_.candidates(cell);
+                if (countBits(candidates) != count)
+                    continue;
+
+                for (; candidates != 0;
+                     candidates &= static_cast<Mask>(candidates - 1)) {
+                    int value = firstBit(candidates);
+                    trial_ = grid_;
+                    trial_.place(cell, value);
+                    int length = propagateSingles(trial_, best_length);
+                    if (length >= 0 && length < best_length) {
+                        best_length = length;
+                        best_cell = cell;
+                        best_value = value;
+                    }
+                }
+            }
+        }
+        if (best_cell < 0)
+            return false;
+
+        // Rounded to the tenth, the sums of 0.1 are not exact
+        grid_.eliminate(best_cell, best_value);
+        score = techniqueScore(FORCING_CHAIN) + lengthScore(best_length + 1);
+        score = std::floor(score * 10 + 0.5) / 10;
+        return true;
+    }
+
+}
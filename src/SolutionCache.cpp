@@ -0,0 +1,116 @@
+//
+// File: SolutionCache.cpp
+//
+
+#include "SolutionCache.hpp"
+#include "Timer.hpp"
+
+
+namespace sudoku
+{
+    const size_t SolutionCache::DEF_CAPACITY = 100000;
+
+
+    SolutionCache::SolutionCache(size_t capacity)
+        : capacity_(capacity > 0 ? capacity : 1),
+          mutex_(),
+          entries_(),
+          index_(),
+          stats_()
+    {
+        index_.reserve(capacity_);
+    }
+
+
+    SolutionCache::~SolutionCache()
+    { }
+
+
+    bool SolutionCache::lookup(const Grid& puzzle, Key& key,
+                               Solver::SOLVE_RESULT& result, Grid& solution)
+    {
+        Timer timer;
+        key.canonical = canonicalize(puzzle, &key.transform);
+        double canonicalize_seconds = timer.lap();
+
+        bool hit = false;
+        Grid canonical_solution;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Index::iterator it = index_.find(key.canonical);
+            if (it != index_.end()) {
+                entries_.splice(entries_.begin(), entries_, it->second);
+                result = it->second->result;
+                canonical_solution = it->second->solution;
+                hit = true;
+            }
+        }
+
+        if (hit && result == Solver::SATISFIABLE)
+            solution = key.transform.inverse().apply(canonical_solution);
+
+        double lookup_seconds = timer.lap();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.lookups += 1;
+            stats_.hits += hit ? 1 : 0;
+            stats_.canonicalize_seconds += canonicalize_seconds;
+            stats_.lookup_seconds += lookup_seconds;
+        }
+        return hit;
+    }
+
+
+    void SolutionCache::insert(const Key& key, Solver::SOLVE_RESULT result,
+                               const Grid& solution)
+    {
+        if (result != Solver::SATISFIABLE && result != Solver::UNSATISFIABLE)
+            return;
+
+        Entry entry;
+        entry.canonical = key.canonical;
+        entry.result = result;
+        if (result == Solver::SATISFIABLE)
+            entry.solution = key.transform.apply(solution);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index_.count(entry.canonical) > 0)
+            return;     // solved by another thread meanwhile
+
+        if (entries_.size() >= capacity_) {
+            index_.erase(entries_.back().canonical);
+            entries_.pop_back();
+            stats_.evictions += 1;
+        }
+
+        entries_.push_front(entry);
+        index_[entry.canonical] = entries_.begin();
+        stats_.insertions += 1;
+    }
+
+
+    SolutionCache::Stats SolutionCache::stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats stats = stats_;
+        stats.entries = entries_.size();
+        return stats;
+    }
+
+
+    //
+    // Private
+    //
+    size_t SolutionCache::GridHash::operator()(const Grid& grid) const
+    {
+        // FNV-1a over the cells
+        const Grid::Cells& cells = grid.getCells();
+        size_t hash = 14695981039346656037ULL;
+        for (int i = 0; i < Grid::NUM_CELLS; ++i) {
+            hash ^= cells[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+}
@@ -7,33 +7,82 @@ namespace sudoku
     const int Solver::DEF_DECISION_LIMIT = 1000;
 
     Solver::Solver()
-        : picosat_(::picosat_init())
-    { }
+        : arena_(NULL),
+          owns_arena_(false),
+          picosat_(NULL),
+          memory_budget_(0),
+          budget_exceeded_(false),
+          deadline_(NULL)
+    {
+        init(NULL);
+    }
 
     Solver::Solver(int seed)
-        : picosat_(::picosat_init())
+        : arena_(NULL),
+          owns_arena_(false),
+          picosat_(NULL),
+          memory_budget_(0),
+          budget_exceeded_(false),
+          deadline_(NULL)
     { 
+        init(NULL);
+        ::picosat_set_seed(picosat_, seed);
+    }
+
+    Solver::Solver(Arena& arena, int seed)
+        : arena_(NULL),
+          owns_arena_(false),
+          picosat_(NULL),
+          memory_budget_(0),
+          budget_exceeded_(false),
+          deadline_(NULL)
+    {
+        init(&arena);
         ::picosat_set_seed(picosat_, seed);
     }
 
     Solver::~Solver()
     {
-        if (picosat_ != NULL)
-            ::picosat_reset(picosat_);
+        // Every PicoSAT block, its manager included, lives in the arena
+        arena_->reset();
+
+        if (owns_arena_)
+            delete arena_;
+        else
+            arena_->release();
     }
 
     //--------
 
     void Solver::clear()
     {
-        if (picosat_ != NULL)
-            ::picosat_reset(picosat_);
-        picosat_ = ::picosat_init();
+        // An instance over the budget does not keep its memory
+        arena_->reset(memory_budget_ > 0 ? memory_budget_ : SIZE_MAX);
+        budget_exceeded_ = false;
+        createPicosat();
     }
 
-    Solver::SOLVE_RESULT Solver::solve(int decision_limit)
+    Solver::SOLVE_RESULT Solver::solve(int decision_limit,
+                                       const Deadline& deadline)
     {
-        int res = picosat_sat(picosat_, decision_limit);
+        // Some clauses were left out, the formula is incomplete
+        if (budget_exceeded_)
+            return OUT_OF_MEMORY;
+
+        int res;
+        if (deadline.unlimited() && memory_budget_ == 0) {
+            res = ::picosat_sat(picosat_, decision_limit);
+        } else {
+            // The assumptions are taken even if the solve can not start, no
+            // decision is made then
+            deadline_ = &deadline;
+            ::picosat_set_interrupt(picosat_, this, &interrupted);
+            res = ::picosat_sat(picosat_, interrupted(this) ? 0
+                                                            : decision_limit);
+            ::picosat_set_interrupt(picosat_, NULL, NULL);
+            deadline_ = NULL;
+        }
+
         // 'PICOSAT_UNSATISFIABLE', 'PICOSAT_SATISFIABLE', or 'PICOSAT_UNKNOWN'.
         switch(res)
         {
@@ -42,14 +91,24 @@ namespace sudoku
             case PICOSAT_UNSATISFIABLE:
                 return UNSATISFIABLE;
             default:
-                return UNKNOWN;
+                return overMemoryBudget() ? OUT_OF_MEMORY : UNKNOWN;
         }
     }
 
+    void Solver::setMemoryBudget(size_t bytes)
+    {
+        memory_budget_ = bytes;
+    }
+
+    bool Solver::overMemoryBudget() const
+    {
+        return budget_exceeded_ || exceedsMemoryBudget();
+    }
+
     // Adds the given literals as a clause
     void Solver::addClause(const std::vector<int>& literals)
     {
-        if (!literals.empty())
+        if (!literals.empty() && !budget_exceeded_)
         {
             std::vector<int> clause(literals);
             clause.push_back(0);
@@ -57,13 +116,43 @@ namespace sudoku
             int *clause_arr = &clause[0];
 
             ::picosat_add_lits(picosat_, clause_arr);
+            budget_exceeded_ = exceedsMemoryBudget();
         }
     }
 
     // Adds a clause to assume a literal value
     void Solver::assumeLiteral(int literal)
     {
-        ::picosat_add_arg(picosat_, literal, 0);
+        if (!budget_exceeded_) {
+            ::picosat_add_arg(picosat_, literal, 0);
+            budget_exceeded_ = exceedsMemoryBudget();
+        }
+    }
+
+    // Assumes a literal value for the next solve() only
+    void Solver::assume(int literal)
+    {
+        ::picosat_assume(picosat_, literal);
+    }
+
+    void Solver::push()
+    {
+        ::picosat_push(picosat_);
+    }
+
+    void Solver::pop()
+    {
+        ::picosat_pop(picosat_);
+    }
+
+    void Solver::setDefaultPhase(int literal, int phase)
+    {
+        ::picosat_set_default_phase_lit(picosat_, literal, phase);
+    }
+
+    void Solver::resetPhases()
+    {
+        ::picosat_reset_phases(picosat_);
     }
 
     Solver::LITERAL_VALUE Solver::getLiteralValue(int literal) const
@@ -84,6 +173,67 @@ namespace sudoku
         }
     }
 
+    // Values of the variables [1, size]
+    void Solver::readModel(int8_t* values, size_t size) const
+    {
+        if (::picosat_res(picosat_) != PICOSAT_SATISFIABLE)
+            throw std::logic_error(
+                "Solve hasn't been called, or the previous call result has "
+                "been UNSATISFIABLE");
+
+        ::picosat_deref_model(picosat_, reinterpret_cast<signed char*>(values),
+                              static_cast<int>(size));
+    }
+
+    std::vector<int> Solver::failedAssumptions() const
+    {
+        if (::picosat_res(picosat_) != PICOSAT_UNSATISFIABLE)
+            throw std::logic_error(
+                "Solve hasn't been called, or the previous call result "
+                "hasn't been UNSATISFIABLE");
+
+        std::vector<int> literals;
+        for (const int* lit = ::picosat_failed_assumptions(picosat_);
+             *lit != 0; ++lit)
+            literals.push_back(*lit);
+        return literals;
+    }
+
+    // Same reduction as picomus, without fixing the result as clauses
+    std::vector<int> Solver::minimalFailedAssumptions()
+    {
+        if (::picosat_res(picosat_) != PICOSAT_UNSATISFIABLE)
+            throw std::logic_error(
+                "Solve hasn't been called, or the previous call result "
+                "hasn't been UNSATISFIABLE");
+
+        std::vector<int> literals;
+        for (const int* lit = ::picosat_mus_assumptions(picosat_, NULL,
+                                                        NULL, 0);
+             *lit != 0; ++lit)
+            literals.push_back(*lit);
+        return literals;
+    }
+
+    const Arena::Stats& Solver::allocatorStats() const
+    {
+        return arena_->stats();
+    }
+
+    Solver::Stats Solver::stats() const
+    {
+        Stats stats;
+        stats.decisions = ::picosat_decisions(picosat_);
+        stats.propagations = ::picosat_propagations(picosat_);
+        stats.conflicts = ::picosat_conflicts(picosat_);
+        stats.visits = ::picosat_visits(picosat_);
+        stats.seconds = ::picosat_seconds(picosat_);
+        stats.variables = ::picosat_variables(picosat_);
+        stats.original_clauses = ::picosat_added_original_clauses(picosat_);
+        stats.peak_bytes = ::picosat_max_bytes_allocated(picosat_);
+        return stats;
+    }
+
     void Solver::addAtLeastOneConstraint(const std::vector<int>& literals)
     {
         addClause(literals);
@@ -112,4 +262,44 @@ namespace sudoku
         addAtLeastOneConstraint(literals);
         addAtMostOneConstraint(literals);
     }
+
+    //
+    // Private
+    //
+
+    bool Solver::exceedsMemoryBudget() const
+    {
+        return memory_budget_ > 0 &&
+               arena_->stats().bytes_in_use > memory_budget_;
+    }
+
+    // PicoSAT interrupt callback, the state is the solver
+    int Solver::interrupted(void* solver)
+    {
+        const Solver* self = static_cast<const Solver*>(solver);
+        return self->deadline_->expired() || self->overMemoryBudget();
+    }
+
+    void Solver::init(Arena* arena)
+    {
+        if (arena == NULL) {
+            arena = &Arena::local();
+            if (!arena->acquire()) {
+                arena = new Arena();
+                owns_arena_ = true;
+            }
+        } else if (!arena->acquire()) {
+            throw std::logic_error("The arena is already used by a solver");
+        }
+
+        arena_ = arena;
+        createPicosat();
+    }
+
+    void Solver::createPicosat()
+    {
+        picosat_ = ::picosat_minit(arena_, &Arena::picosatNew,
+                                   &Arena::picosatResize,
+                                   &Arena::picosatDelete);
+    }
 }
@@ -0,0 +1,255 @@
+//
+// File: SolverPool.cpp
+//
+
+#include <ctime>
+
+#include <algorithm>
+#include <map>
+
+#include "SolverPool.hpp"
+
+
+namespace sudoku
+{
+    const size_t SolverPool::DEF_MAX_IDLE_PER_THREAD = 4;
+    const size_t SolverPool::DEF_MAX_USES = 10000;
+
+
+    struct SolverPool::Entry
+    {
+        explicit Entry(int seed)
+            : arena(),
+              solver(arena, seed),
+              uses(0)
+        { }
+
+        Arena arena;
+        Solver solver;
+        size_t uses;
+    };
+
+
+    // Live pools, so an exiting thread can give its idle solvers back
+    static std::mutex registry_mutex;
+    static std::map<unsigned long, SolverPool*> registry;
+    static std::atomic<unsigned long> next_pool_id(1);
+
+
+    // Free lists of the calling thread, one per pool it has used. Pool ids
+    // are never reused, the lists of destroyed pools are simply ignored.
+    struct LocalCache
+    {
+        struct List
+        {
+            unsigned long pool_id;
+            std::vector<SolverPool::Entry*> entries;
+        };
+
+        ~LocalCache()
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            for (size_t i = 0; i < lists.size(); ++i) {
+                std::map<unsigned long, SolverPool*>::iterator it =
+                    registry.find(lists[i].pool_id);
+                if (it != registry.end())
+                    it->second->releaseShared(lists[i].entries);
+            }
+        }
+
+        std::vector<List> lists;
+    };
+
+    static thread_local LocalCache local_cache;
+
+
+    //--------
+
+    SolverPool::SolverPool(Initializer initializer,
+                           size_t max_idle_per_thread, size_t max_uses)
+        : id_(next_pool_id++),
+          initializer_(initializer),
+          max_idle_per_thread_(max_idle_per_thread),
+          max_uses_(max_uses),
+          memory_budget_(0),
+          leases_(0),
+          local_hits_(0),
+          mutex_(),
+          shared_(),
+          all_(),
+          shared_hits_(0),
+          rebuilt_(0)
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry[id_] = this;
+    }
+
+
+    SolverPool::~SolverPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            registry.erase(id_);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < all_.size(); ++i)
+            delete all_[i];
+    }
+
+
+    void SolverPool::prewarm(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            Entry* entry = createEntry();
+            std::lock_guard<std::mutex> lock(mutex_);
+            shared_.push_back(entry);
+        }
+    }
+
+
+    void SolverPool::setMemoryBudget(size_t bytes)
+    {
+        memory_budget_.store(bytes, std::memory_order_relaxed);
+    }
+
+
+    SolverPool::Stats SolverPool::stats() const
+    {
+        Stats stats;
+        stats.leases = leases_.load(std::memory_order_relaxed);
+        stats.local_hits = local_hits_.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.created = all_.size();
+        stats.rebuilt = rebuilt_;
+        stats.shared_hits = shared_hits_;
+        return stats;
+    }
+
+
+    //--------
+
+    SolverPool::Lease::Lease(SolverPool& pool)
+        : pool_(pool),
+          entry_(pool.acquire())
+    { }
+
+
+    SolverPool::Lease::~Lease()
+    {
+        pool_.release(entry_);
+    }
+
+
+    Solver& SolverPool::Lease::operator*() const
+    {
+        return entry_->solver;
+    }
+
+
+    Solver* SolverPool::Lease::operator->() const
+    {
+        return &entry_->solver;
+    }
+
+
+    //
+    // Private
+    //
+    SolverPool::Entry* SolverPool::acquire()
+    {
+        leases_.fetch_add(1, std::memory_order_relaxed);
+
+        Entry* entry = NULL;
+        std::vector<Entry*>& local = localList();
+        if (!local.empty()) {
+            entry = local.back();
+            local.pop_back();
+            local_hits_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!shared_.empty()) {
+                entry = shared_.back();
+                shared_.pop_back();
+                shared_hits_ += 1;
+            }
+        }
+        if (entry == NULL)
+            entry = createEntry();
+
+        entry->solver.setMemoryBudget(
+            memory_budget_.load(std::memory_order_relaxed));
+        return entry;
+    }
+
+
+    void SolverPool::release(Entry* entry)
+    {
+        entry->uses += 1;
+        if ((max_uses_ > 0 && entry->uses >= max_uses_) ||
+            entry->solver.overMemoryBudget()) {
+            entry->solver.clear();
+            if (initializer_ != NULL)
+                initializer_(entry->solver);
+            entry->uses = 0;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            rebuilt_ += 1;
+        }
+
+        std::vector<Entry*>& local = localList();
+        if (local.size() < max_idle_per_thread_) {
+            local.push_back(entry);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        shared_.push_back(entry);
+    }
+
+
+    SolverPool::Entry* SolverPool::createEntry()
+    {
+        Entry* entry = new Entry(static_cast<int>(::time(NULL)));
+        if (initializer_ != NULL)
+            initializer_(entry->solver);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        all_.push_back(entry);
+        return entry;
+    }
+
+
+    void SolverPool::releaseShared(const std::vector<Entry*>& entries)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shared_.insert(shared_.end(), entries.begin(), entries.end());
+    }
+
+
+    std::vector<SolverPool::Entry*>& SolverPool::localList()
+    {
+        std::vector<LocalCache::List>& lists = local_cache.lists;
+        for (size_t i = 0; i < lists.size(); ++i) {
+            if (lists[i].pool_id == id_)
+                return lists[i].entries;
+        }
+
+        // First use of this pool in the thread, forget the dead pools
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            size_t alive = 0;
+            for (size_t i = 0; i < lists.size(); ++i) {
+                if (registry.count(lists[i].pool_id) > 0)
+                    std::swap(lists[alive++], lists[i]);
+            }
+            lists.resize(alive);
+        }
+
+        lists.push_back(LocalCache::List());
+        lists.back().pool_id = id_;
+        return lists.back().entries;
+    }
+
+}
@@ -0,0 +1,48 @@
+//
+// File: SudokuBinaryOutputter.cpp
+//
+
+#include <cstring>
+
+#include "Grid.hpp"
+#include "SudokuBinaryOutputter.hpp"
+
+
+namespace sudoku
+{
+    SudokuBinaryOutputter::SudokuBinaryOutputter(std::ostream& out_stream,
+                                                 bool pairs)
+        : SudokuOutputter(out_stream),
+          pairs_(pairs)
+    { }
+
+
+    SudokuBinaryOutputter::~SudokuBinaryOutputter()
+    { }
+
+
+    void SudokuBinaryOutputter::output(const Grid& sudoku)
+    {
+        // The cells are stored as their values already
+        char* out = reserve(Grid::NUM_CELLS);
+        ::memcpy(out, sudoku.getCells().data(), Grid::NUM_CELLS);
+        commit();
+    }
+
+
+    void SudokuBinaryOutputter::output(const Grid& puzzle,
+                                       const Grid& solution)
+    {
+        if (!pairs_) {
+            output(solution);
+            return;
+        }
+
+        char* out = reserve(2 * Grid::NUM_CELLS);
+        ::memcpy(out, puzzle.getCells().data(), Grid::NUM_CELLS);
+        ::memcpy(out + Grid::NUM_CELLS, solution.getCells().data(),
+                 Grid::NUM_CELLS);
+        commit();
+    }
+
+}
@@ -3,68 +3,79 @@
 // File: SudokuFormattedOutputter.cpp
 //
 
-#include <iostream>
+#include <cstring>
 
-#include "Sudoku.hpp"
+#include "Grid.hpp"
 #include "SudokuFormattedOutputter.hpp"
 
 
-namespace sudoku 
+namespace sudoku
 {
     SudokuFormattedOutputter::SudokuFormattedOutputter(
             std::ostream& out_stream)
-        : SudokuOutputter(out_stream)
-    { }
+        : SudokuOutputter(out_stream),
+          template_(),
+          cell_offsets_()
+    {
+        cell_offsets_.reserve(Grid::NUM_ROWS * Grid::NUM_COLUMNS);
+
+        for (int i = 0; i < Grid::NUM_ROWS; ++i) {
+            appendRowSeparator(i);  // row region Separator
+
+            for (int j = 0; j < Grid::NUM_COLUMNS; ++j) {
+                appendColumnSeparator(j);
+                template_ += ' ';
+                cell_offsets_.push_back(template_.size());
+                template_ += "  ";
+            }
+
+            appendColumnSeparator(Grid::NUM_COLUMNS);
+            template_ += '\n';
+        }
+
+        appendRowSeparator(Grid::NUM_ROWS);  // last row Separator
+    }
 
 
     SudokuFormattedOutputter::~SudokuFormattedOutputter()
     { }
 
 
-    void SudokuFormattedOutputter::output(const Sudoku& sudoku)
+    void SudokuFormattedOutputter::output(const Grid& sudoku)
     {
-        std::ostream& os = getStream();
-
-        for (int i = 0; i < Sudoku::NUM_ROWS; ++i) {
-            outputRowSeparator(i);  // row region Separator
-
-            for (int j = 0; j < Sudoku::NUM_COLUMNS; ++j) {
-                outputColumnSeparator(j);
-                int value = sudoku.getValue(i, j);
-                if (value == Sudoku::UNDEFINED_VALUE) {
-                    os << "   ";
-                } else {
-                    os << " " << value << " ";
-                }
+        char* out = reserve(template_.size());
+        ::memcpy(out, template_.data(), template_.size());
+
+        size_t cell = 0;
+        for (int i = 0; i < Grid::NUM_ROWS; ++i) {
+            for (int j = 0; j < Grid::NUM_COLUMNS; ++j, ++cell) {
+                int value = sudoku.getValueUnchecked(i, j);
+                if (value != Grid::UNDEFINED_VALUE)
+                    out[cell_offsets_[cell]] = static_cast<char>('0' + value);
             }
-
-            outputColumnSeparator(Sudoku::NUM_COLUMNS);
-            os << std::endl;
         }
 
-        outputRowSeparator(Sudoku::NUM_ROWS);  // last row Separator
+        commit();
     }
 
 
     // ------------------------------------------------------------------------
     // Private functions
 
-    void SudokuFormattedOutputter::outputRowSeparator(int row) {
-        std::ostream& os = getStream();
-        std::string sep = (row % Sudoku::SUBREGION_NUM_ROWS) ? "---" : "===";
+    void SudokuFormattedOutputter::appendRowSeparator(int row) {
+        const char* sep = (row % Grid::SUBREGION_NUM_ROWS) ? "---" : "===";
 
-        for (int i = 0; i < Sudoku::NUM_COLUMNS; ++i) {
-            outputColumnSeparator(i);
-            os << sep;
+        for (int i = 0; i < Grid::NUM_COLUMNS; ++i) {
+            appendColumnSeparator(i);
+            template_ += sep;
         }
-        outputColumnSeparator(Sudoku::NUM_COLUMNS);
-        os << std::endl;
+        appendColumnSeparator(Grid::NUM_COLUMNS);
+        template_ += '\n';
     }
 
 
-    void SudokuFormattedOutputter::outputColumnSeparator(int column) {
-        std::ostream& os = getStream();
-        os << (column % Sudoku::SUBREGION_NUM_COLUMNS ? "|" : "‖");
+    void SudokuFormattedOutputter::appendColumnSeparator(int column) {
+        template_ += (column % Grid::SUBREGION_NUM_COLUMNS ? "|" : "‖");
     }
-    
+
 }
@@ -0,0 +1,183 @@
+//
+// File: SudokuJsonOutputter.cpp
+//
+
+#include <cstring>
+
+#include "Grid.hpp"
+#include "SudokuJsonOutputter.hpp"
+
+
+namespace sudoku
+{
+    namespace
+    {
+        // Longest record without the id and the error message, with all
+        // the numbers at their widest
+        const size_t MAX_RECORD_SIZE = 768;
+
+        // Escaping a character takes up to 6 bytes, F.E: \u001f
+        const size_t MAX_ESCAPED_SIZE = 6;
+
+        const char* const STATUS_NAMES[] = {
+            "UNSATISFIABLE",
+            "SATISFIABLE",
+            "UNKNOWN",
+            "OUT_OF_MEMORY"
+        };
+
+        const char HEX_DIGITS[] = "0123456789abcdef";
+
+        inline char* writeText(char* out, const char* text)
+        {
+            size_t length = strlen(text);
+            memcpy(out, text, length);
+            return out + length;
+        }
+
+        char* writeUnsigned(char* out, unsigned long long value)
+        {
+            char digits[20];
+            int n = 0;
+            do {
+                digits[n++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+
+            while (n > 0)
+                *out++ = digits[--n];
+            return out;
+        }
+
+        // Microseconds with three decimals, F.E: 12.345
+        char* writeMicroseconds(char* out, double seconds)
+        {
+            unsigned long long nanoseconds = (seconds > 0)
+                ? static_cast<unsigned long long>(seconds * 1e9 + 0.5) : 0;
+
+            out = writeUnsigned(out, nanoseconds / 1000);
+            unsigned fraction = static_cast<unsigned>(nanoseconds % 1000);
+            *out++ = '.';
+            *out++ = static_cast<char>('0' + fraction / 100);
+            *out++ = static_cast<char>('0' + fraction / 10 % 10);
+            *out++ = static_cast<char>('0' + fraction % 10);
+            return out;
+        }
+
+        char* writeEscaped(char* out, const char* text)
+        {
+            for (; *text != '\0'; ++text) {
+                unsigned char c = static_cast<unsigned char>(*text);
+                if (c == '"' || c == '\\') {
+                    *out++ = '\\';
+                    *out++ = static_cast<char>(c);
+                } else if (c < 0x20) {
+                    out = writeText(out, "\\u00");
+                    *out++ = HEX_DIGITS[c >> 4];
+                    *out++ = HEX_DIGITS[c & 0xf];
+                } else {
+                    *out++ = static_cast<char>(c);
+                }
+            }
+            return out;
+        }
+
+        char* writeGrid(char* out, const Grid& grid)
+        {
+            const Grid::Cells& cells = grid.getCells();
+            for (int i = 0; i < Grid::NUM_CELLS; ++i) {
+                *out++ = (cells[i] == Grid::UNDEFINED_VALUE)
+                    ? '.' : static_cast<char>('0' + cells[i]);
+            }
+            return out;
+        }
+    }
+
+
+    SudokuJsonOutputter::SudokuJsonOutputter(std::ostream& out_stream)
+        : SudokuOutputter(out_stream)
+    { }
+
+
+    SudokuJsonOutputter::~SudokuJsonOutputter()
+    { }
+
+
+    void SudokuJsonOutputter::output(const Grid& sudoku)
+    {
+        Record record = Record();
+        record.id = "null";
+        record.id_length = 4;
+        record.result = Solver::SATISFIABLE;
+        record.solution = &sudoku;
+        output(record);
+    }
+
+
+    void SudokuJsonOutputter::output(const Record& record)
+    {
+        size_t size = MAX_RECORD_SIZE + record.id_length;
+        if (record.error != NULL)
+            size += MAX_ESCAPED_SIZE * strlen(record.error);
+        char* out = reserve(size);
+
+        out = writeText(out, "{\"id\":");
+        memcpy(out, record.id, record.id_length);
+        out += record.id_length;
+
+        out = writeText(out, ",\"status\":\"");
+        if (record.error != NULL) {
+            out = writeText(out, "ERROR\",\"error\":\"");
+            out = writeEscaped(out, record.error);
+        } else {
+            out = writeText(out, statusName(record.result));
+        }
+        *out++ = '"';
+
+        if (record.error == NULL && record.result == Solver::SATISFIABLE &&
+            record.solution != NULL) {
+            out = writeText(out, ",\"solution\":\"");
+            out = writeGrid(out, *record.solution);
+            *out++ = '"';
+        }
+
+        if (record.stats != NULL) {
+            const Solver::Stats& stats = *record.stats;
+            out = writeText(out, ",\"stats\":{\"decisions\":");
+            out = writeUnsigned(out, stats.decisions);
+            out = writeText(out, ",\"propagations\":");
+            out = writeUnsigned(out, stats.propagations);
+            out = writeText(out, ",\"conflicts\":");
+            out = writeUnsigned(out, stats.conflicts);
+            out = writeText(out, ",\"visits\":");
+            out = writeUnsigned(out, stats.visits);
+            out = writeText(out, ",\"peak_bytes\":");
+            out = writeUnsigned(out, stats.peak_bytes);
+            *out++ = '}';
+        }
+
+        if (record.timings != NULL) {
+            const SudokuSolver::Timings& timings = *record.timings;
+            out = writeText(out, ",\"timings\":{\"parse_us\":");
+            out = writeMicroseconds(out, record.parse);
+            out = writeText(out, ",\"encode_us\":");
+            out = writeMicroseconds(out, timings.encode);
+            out = writeText(out, ",\"solve_us\":");
+            out = writeMicroseconds(out, timings.solve);
+            out = writeText(out, ",\"extract_us\":");
+            out = writeMicroseconds(out, timings.extract);
+            *out++ = '}';
+        }
+
+        *out++ = '}';
+        *out++ = '\n';
+        commit(out);
+    }
+
+
+    const char* SudokuJsonOutputter::statusName(Solver::SOLVE_RESULT result)
+    {
+        return STATUS_NAMES[result];
+    }
+
+}
@@ -0,0 +1,308 @@
+//
+// File: SudokuJsonReader.cpp
+//
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+
+#include <istream>
+#include <sstream>
+
+#include "Grid.hpp"
+#include "SudokuJsonReader.hpp"
+
+
+namespace sudoku
+{
+    namespace
+    {
+        // Deepest nesting of the skipped members
+        const int MAX_DEPTH = 64;
+
+        const char NULL_ID[] = "null";
+
+        inline bool isBlank(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        inline bool isDigit(char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        inline const char* skipBlanks(const char* p, const char* end)
+        {
+            while (p != end && isBlank(*p))
+                ++p;
+            return p;
+        }
+
+        inline bool equals(const char* str, size_t length, const char* name)
+        {
+            return strlen(name) == length && memcmp(str, name, length) == 0;
+        }
+
+        inline bool isHexDigit(char c)
+        {
+            return isDigit(c) || (c >= 'a' && c <= 'f') ||
+                   (c >= 'A' && c <= 'F');
+        }
+
+        // From the character after the backslash to the last one of the
+        // escape, F.E: \n or \u00e9
+        const char* skipEscape(const char* p, const char* end)
+        {
+            if (*p != '\0' && strchr("\"\\/bfnrt", *p) != NULL)
+                return p;
+            if (*p != 'u')
+                throw IOError("invalid escape");
+            for (int i = 0; i < 4; ++i) {
+                if (++p == end || !isHexDigit(*p))
+                    throw IOError("invalid escape");
+            }
+            return p;
+        }
+
+        // From the opening quote to past the closing one
+        const char* skipString(const char* p, const char* end)
+        {
+            for (++p; p != end; ++p) {
+                unsigned char c = static_cast<unsigned char>(*p);
+                if (c == '"')
+                    return p + 1;
+                if (c == '\\') {
+                    if (++p == end)
+                        break;
+                    p = skipEscape(p, end);
+                } else if (c < 0x20) {
+                    throw IOError("control character in a string");
+                }
+            }
+            throw IOError("unterminated string");
+        }
+
+        inline const char* skipDigits(const char* p, const char* end)
+        {
+            while (p != end && isDigit(*p))
+                ++p;
+            return p;
+        }
+
+        // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+        const char* skipNumber(const char* p, const char* end)
+        {
+            if (p != end && *p == '-')
+                ++p;
+            if (p == end || !isDigit(*p))
+                throw IOError("invalid number");
+            p = (*p == '0') ? p + 1 : skipDigits(p, end);
+
+            if (p != end && *p == '.') {
+                if (++p == end || !isDigit(*p))
+                    throw IOError("invalid number");
+                p = skipDigits(p, end);
+            }
+
+            if (p != end && (*p == 'e' || *p == 'E')) {
+                if (++p != end && (*p == '+' || *p == '-'))
+                    ++p;
+                if (p == end || !isDigit(*p))
+                    throw IOError("invalid number");
+                p = skipDigits(p, end);
+            }
+            return p;
+        }
+
+        // true, false, null or a number
+        const char* skipLiteral(const char* p, const char* end)
+        {
+            const char* begin = p;
+            if (*p == '-' || isDigit(*p)) {
+                p = skipNumber(p, end);
+                // F.E: 01, 1-2 or 1.5.3
+                if (p != end && (isalnum(static_cast<unsigned char>(*p)) ||
+                                 *p == '-' || *p == '+' || *p == '.'))
+                    throw IOError("invalid number");
+                return p;
+            }
+
+            while (p != end && isalnum(static_cast<unsigned char>(*p)))
+                ++p;
+            size_t length = p - begin;
+            if (!equals(begin, length, "true") &&
+                !equals(begin, length, "false") &&
+                !equals(begin, length, "null"))
+                throw IOError("invalid value");
+            return p;
+        }
+
+        // Objects and arrays are only checked to be balanced
+        const char* skipValue(const char* p, const char* end)
+        {
+            if (p == end)
+                throw IOError("expected a value");
+            if (*p == '"')
+                return skipString(p, end);
+            if (*p != '{' && *p != '[')
+                return skipLiteral(p, end);
+
+            char closing[MAX_DEPTH];
+            int depth = 0;
+            while (p != end) {
+                char c = *p;
+                if (c == '"') {
+                    p = skipString(p, end);
+                    continue;
+                }
+                if (c == '{' || c == '[') {
+                    if (depth == MAX_DEPTH)
+                        throw IOError("too deeply nested");
+                    closing[depth++] = (c == '{') ? '}' : ']';
+                } else if (c == '}' || c == ']') {
+                    if (closing[--depth] != c)
+                        throw IOError("mismatched brackets");
+                    if (depth == 0)
+                        return p + 1;
+                }
+                ++p;
+            }
+            throw IOError("unterminated value");
+        }
+
+        void parsePuzzle(const char* str, size_t length, Grid& puzzle)
+        {
+            if (length != static_cast<size_t>(Grid::NUM_CELLS)) {
+                std::ostringstream oss;
+                oss << "expected " << Grid::NUM_CELLS << " cells, found "
+                    << length;
+                throw IOError(oss.str());
+            }
+
+            Grid::Cells cells;
+            for (int i = 0; i < Grid::NUM_CELLS; ++i) {
+                char c = str[i];
+                if (c >= '1' && c <= '9') {
+                    cells[i] = static_cast<uint8_t>(c - '0');
+                } else if (c == '.' || c == '0') {
+                    cells[i] = Grid::UNDEFINED_VALUE;
+                } else {
+                    std::ostringstream oss;
+                    oss << "invalid cell '" << c << "'";
+                    throw IOError(oss.str());
+                }
+            }
+            puzzle = Grid(cells);
+        }
+    }
+
+
+    SudokuJsonReader::SudokuJsonReader(std::istream& in_stream)
+        : in_stream_(in_stream),
+          line_(),
+          line_num_(0)
+    { }
+
+
+    SudokuJsonReader::~SudokuJsonReader()
+    { }
+
+
+    bool SudokuJsonReader::read(Record& record)
+    {
+        while (std::getline(in_stream_, line_)) {
+            ++line_num_;
+
+            if (line_.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+
+            try {
+                const char* begin = line_.data();
+                parseRecord(begin, begin + line_.size(), record);
+            } catch (const IOError& e) {
+                std::ostringstream oss;
+                oss << "Error loading sudoku. Line: " << line_num_
+                    << " (" << e.what() << ")";
+                throw IOError(oss.str());
+            }
+            return true;
+        }
+        return false;
+    }
+
+
+    int SudokuJsonReader::getLineNumber() const
+    {
+        return line_num_;
+    }
+
+
+    void SudokuJsonReader::parseRecord(const char* begin, const char* end,
+                                       Record& record)
+    {
+        record.id = NULL_ID;
+        record.id_length = sizeof(NULL_ID) - 1;
+
+        // The puzzle is checked last, so that errors in it keep the id
+        const char* puzzle = NULL;
+        size_t puzzle_length = 0;
+
+        const char* p = skipBlanks(begin, end);
+        if (p == end || *p != '{')
+            throw IOError("expected a JSON object");
+        p = skipBlanks(p + 1, end);
+
+        if (p != end && *p == '}') {
+            ++p;
+        } else {
+            for (;;) {
+                if (p == end || *p != '"')
+                    throw IOError("expected a member name");
+                const char* name = p + 1;
+                p = skipString(p, end);
+                size_t name_length = p - name - 1;
+
+                p = skipBlanks(p, end);
+                if (p == end || *p != ':')
+                    throw IOError("expected ':'");
+                p = skipBlanks(p + 1, end);
+
+                const char* value = p;
+                p = skipValue(p, end);
+
+                if (equals(name, name_length, "id")) {
+                    if (*value == '{' || *value == '[' || *value == 't' ||
+                        *value == 'f')
+                        throw IOError("the id must be a string, a number "
+                                      "or null");
+                    record.id = value;
+                    record.id_length = p - value;
+                } else if (equals(name, name_length, "puzzle")) {
+                    if (*value != '"')
+                        throw IOError("the puzzle must be a string");
+                    puzzle = value + 1;
+                    puzzle_length = p - value - 2;
+                }
+
+                p = skipBlanks(p, end);
+                if (p != end && *p == ',') {
+                    p = skipBlanks(p + 1, end);
+                } else if (p != end && *p == '}') {
+                    ++p;
+                    break;
+                } else {
+                    throw IOError("expected ',' or '}'");
+                }
+            }
+        }
+
+        if (skipBlanks(p, end) != end)
+            throw IOError("unexpected characters after the record");
+        if (puzzle == NULL)
+            throw IOError("missing puzzle");
+
+        parsePuzzle(puzzle, puzzle_length, record.puzzle);
+    }
+
+}
@@ -0,0 +1,68 @@
+//
+// File: SudokuLineOutputter.cpp
+//
+
+#include "Grid.hpp"
+#include "SudokuLineOutputter.hpp"
+
+
+namespace sudoku
+{
+    SudokuLineOutputter::SudokuLineOutputter(std::ostream& out_stream,
+                                             bool pairs)
+        : SudokuOutputter(out_stream),
+          pairs_(pairs)
+    { }
+
+
+    SudokuLineOutputter::~SudokuLineOutputter()
+    { }
+
+
+    void SudokuLineOutputter::output(const Grid& sudoku)
+    {
+        const int num_cells = Grid::NUM_ROWS * Grid::NUM_COLUMNS;
+        char* out = reserve(num_cells + 1);
+
+        formatGrid(sudoku, out);
+        out[num_cells] = '\n';
+
+        commit();
+    }
+
+
+    void SudokuLineOutputter::output(const Grid& puzzle,
+                                     const Grid& solution)
+    {
+        if (!pairs_) {
+            output(solution);
+            return;
+        }
+
+        const int num_cells = Grid::NUM_ROWS * Grid::NUM_COLUMNS;
+        char* out = reserve(2 * num_cells + 2);
+
+        formatGrid(puzzle, out);
+        out[num_cells] = ',';
+        formatGrid(solution, out + num_cells + 1);
+        out[2 * num_cells + 1] = '\n';
+
+        commit();
+    }
+
+
+    // ------------------------------------------------------------------------
+    // Private functions
+
+    void SudokuLineOutputter::formatGrid(const Grid& sudoku, char* out)
+    {
+        for (int i = 0; i < Grid::NUM_ROWS; ++i) {
+            for (int j = 0; j < Grid::NUM_COLUMNS; ++j) {
+                int value = sudoku.getValueUnchecked(i, j);
+                *out++ = (value == Grid::UNDEFINED_VALUE)
+                    ? '.' : static_cast<char>('0' + value);
+            }
+        }
+    }
+
+}
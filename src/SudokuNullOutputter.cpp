@@ -0,0 +1,27 @@
+//
+// File: SudokuNullOutputter.cpp
+//
+
+#include "Grid.hpp"
+#include "SudokuNullOutputter.hpp"
+
+
+namespace sudoku
+{
+    SudokuNullOutputter::SudokuNullOutputter(std::ostream& out_stream)
+        : SudokuOutputter(out_stream)
+    { }
+
+
+    SudokuNullOutputter::~SudokuNullOutputter()
+    { }
+
+
+    void SudokuNullOutputter::output(const Grid&)
+    { }
+
+
+    void SudokuNullOutputter::output(const Grid&, const Grid&)
+    { }
+
+}
@@ -3,18 +3,52 @@
 // File: SudokuOutputter.cpp
 //
 
+#include <ostream>
+
 #include "SudokuOutputter.hpp"
 
 
-namespace sudoku 
+namespace sudoku
 {
     SudokuOutputter::SudokuOutputter(std::ostream& out_stream)
-        : out_stream_(out_stream)
+        : out_stream_(out_stream),
+          buffer_(),
+          buffer_size_(0),
+          auto_flush_(false)
     { }
 
 
     SudokuOutputter::~SudokuOutputter()
-    { }
+    {
+        writeBuffer();
+    }
+
+
+    void SudokuOutputter::output(const Grid&, const Grid& solution)
+    {
+        output(solution);
+    }
+
+
+    void SudokuOutputter::flush()
+    {
+        writeBuffer();
+        out_stream_.flush();
+    }
+
+
+    void SudokuOutputter::setBufferSize(size_t bytes)
+    {
+        buffer_size_ = bytes;
+        if (buffer_.size() > buffer_size_)
+            writeBuffer();
+    }
+
+
+    void SudokuOutputter::setAutoFlush(bool auto_flush)
+    {
+        auto_flush_ = auto_flush;
+    }
 
 
     std::ostream& SudokuOutputter::getStream()
@@ -22,4 +56,41 @@ namespace sudoku
         return out_stream_;
     }
 
+
+    char* SudokuOutputter::reserve(size_t size)
+    {
+        size_t used = buffer_.size();
+        buffer_.resize(used + size);
+        return &buffer_[used];
+    }
+
+
+    void SudokuOutputter::commit()
+    {
+        if (auto_flush_) {
+            flush();
+        } else if (buffer_.size() > buffer_size_) {
+            writeBuffer();
+        }
+    }
+
+
+    void SudokuOutputter::commit(const char* end)
+    {
+        buffer_.resize(end - buffer_.data());
+        commit();
+    }
+
+
+    // ------------------------------------------------------------------------
+    // Private functions
+
+    void SudokuOutputter::writeBuffer()
+    {
+        if (!buffer_.empty()) {
+            out_stream_.write(&buffer_[0], buffer_.size());
+            buffer_.clear();  // keeps the capacity for the next grids
+        }
+    }
+
 }
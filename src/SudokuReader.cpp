@@ -0,0 +1,132 @@
+//
+// File: SudokuReader.cpp
+//
+
+#include <cctype>
+
+#include <istream>
+#include <sstream>
+
+#include "Grid.hpp"
+#include "SudokuReader.hpp"
+
+
+namespace sudoku
+{
+    SudokuReader::SudokuReader(std::istream& in_stream)
+        : in_stream_(in_stream),
+          line_(),
+          line_num_(0),
+          line_format_(false),
+          done_(false)
+    {
+        line_format_ = detectLineFormat();
+    }
+
+
+    SudokuReader::~SudokuReader()
+    { }
+
+
+    bool SudokuReader::read(Grid& sudoku)
+    {
+        if (done_)
+            return false;
+
+        if (!line_format_) {
+            done_ = true;   // a single sudoku per stream
+            readCells(sudoku);
+            return true;
+        }
+
+        while (std::getline(in_stream_, line_)) {
+            ++line_num_;
+
+            size_t pos = line_.find_first_not_of(" \t\r");
+            if (pos == std::string::npos || line_[pos] == '#')
+                continue;
+
+            try {
+                parseLine(line_, sudoku);
+            } catch (const IOError& e) {
+                std::ostringstream oss;
+                oss << "Error loading sudoku. Line: " << line_num_
+                    << " (" << e.what() << ")";
+                throw IOError(oss.str());
+            }
+            return true;
+        }
+
+        done_ = true;
+        return false;
+    }
+
+
+    bool SudokuReader::isLineFormat() const
+    {
+        return line_format_;
+    }
+
+
+    int SudokuReader::getLineNumber() const
+    {
+        return line_num_;
+    }
+
+
+    void SudokuReader::parseLine(const std::string& line, Grid& sudoku)
+    {
+        // Tolerate trailing blanks and DOS line endings
+        size_t length = line.find_last_not_of(" \t\r") + 1;
+
+        try {
+            sudoku = Grid::fromString(line.substr(0, length));
+        } catch (const std::invalid_argument& e) {
+            throw IOError(e.what());
+        }
+    }
+
+
+    // ------------------------------------------------------------------------
+    // Private functions
+
+    // The "<row> <column> value" format always starts with a single digit
+    // followed by a blank, a sudoku line never has a blank in it.
+    bool SudokuReader::detectLineFormat()
+    {
+        in_stream_ >> std::ws;
+        if (in_stream_.peek() == '#')
+            return true;
+
+        int first = in_stream_.get();
+        if (first == std::char_traits<char>::eof())
+            return false;
+
+        int second = in_stream_.peek();
+        in_stream_.unget();
+
+        return second != std::char_traits<char>::eof() && !::isspace(second);
+    }
+
+
+    void SudokuReader::readCells(Grid& sudoku)
+    {
+        int row, column, value;
+
+        while (in_stream_.good()) {
+            in_stream_ >> row >> column >> value;
+
+            if ((in_stream_.bad() || in_stream_.fail()) &&
+                !in_stream_.eof()) {  // Add option to ignore errors
+                std::ostringstream oss;
+                oss << "Error loading sudoku. Line: " << line_num_;
+                in_stream_.clear();
+                throw IOError(oss.str());
+            } else if (!in_stream_.fail()) {
+                line_num_ += 1;
+                sudoku.setValue(--row, --column, value);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,574 @@
+//
+// File: SudokuServer.cpp
+//
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "Grid.hpp"
+#include "SudokuServer.hpp"
+
+
+namespace sudoku
+{
+    const size_t SudokuServer::DEF_MAX_LINE_LENGTH = 1024;
+    const size_t SudokuServer::DEF_MAX_PIPELINE = 256;
+
+    // epoll ids of the non connection descriptors
+    static const uint64_t LISTEN_ID = 0;
+    static const uint64_t WAKE_ID = 1;
+
+    static const int MAX_EVENTS = 64;
+    static const size_t READ_SIZE = 16 * 1024;
+
+
+    struct SudokuServer::Connection
+    {
+        uint64_t id;
+        int fd;
+        uint32_t events;            // events registered in epoll
+
+        std::string in;             // bytes read, not parsed yet
+        std::string out;            // responses not written yet
+        size_t out_pos;
+
+        uint64_t next_seq;          // sequence of the next request
+        uint64_t next_send;         // sequence of the next response
+        std::map<uint64_t, std::string> ready;  // solved out of order
+
+        bool read_closed;           // EOF or an unrecoverable request
+
+        size_t inFlight() const { return next_seq - next_send; }
+    };
+
+
+    // Builds the message of a failed system call
+    static std::string systemError(const std::string& what)
+    {
+        return what + ": " + ::strerror(errno);
+    }
+
+
+    //--------
+
+    SudokuServer::SudokuServer(const std::string& socket_path,
+                               size_t num_workers, SolutionCache* cache,
+                               double request_timeout)
+        : socket_path_(socket_path),
+          num_workers_(num_workers > 0 ? num_workers : 1),
+          cache_(cache),
+          max_line_length_(DEF_MAX_LINE_LENGTH),
+          max_pipeline_(DEF_MAX_PIPELINE),
+          request_timeout_(request_timeout),
+          listen_fd_(-1),
+          bound_(false),
+          epoll_fd_(-1),
+          wake_fd_(-1),
+          stopping_(false),
+          cancel_(),
+          connections_(),
+          next_connection_id_(WAKE_ID + 1),
+          workers_(),
+          jobs_mutex_(),
+          jobs_cond_(),
+          jobs_(),
+          workers_done_(false),
+          results_mutex_(),
+          results_()
+    { }
+
+
+    SudokuServer::~SudokuServer()
+    {
+        tearDown();
+    }
+
+
+    void SudokuServer::run()
+    {
+        try {
+            setUp();
+        } catch (...) {
+            tearDown();
+            throw;
+        }
+
+        epoll_event events[MAX_EVENTS];
+        while (!stopping_.load()) {
+            int n = ::epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                std::string msg = systemError("epoll_wait");
+                tearDown();
+                throw ServerError(msg);
+            }
+
+            for (int i = 0; i < n; ++i) {
+                uint64_t id = events[i].data.u64;
+                if (id == LISTEN_ID) {
+                    acceptConnections();
+                } else if (id == WAKE_ID) {
+                    uint64_t count;
+                    ssize_t ret = ::read(wake_fd_, &count, sizeof(count));
+                    (void) ret;     // only used to clear the eventfd
+                    deliverResults();
+                } else {
+                    // The connection may be closed by a previous event
+                    std::map<uint64_t, Connection*>::iterator it =
+                        connections_.find(id);
+                    if (it == connections_.end())
+                        continue;
+
+                    // A hung up client can not read the responses either
+                    Connection& conn = *it->second;
+                    if (events[i].events & (EPOLLHUP | EPOLLERR))
+                        closeConnection(conn);
+                    else if (events[i].events & EPOLLIN)
+                        readConnection(conn);
+                    else if (events[i].events & EPOLLOUT)
+                        writeConnection(conn);
+                }
+            }
+        }
+
+        tearDown();
+    }
+
+
+    void SudokuServer::stop()
+    {
+        stopping_.store(true);
+        cancel_.cancel();
+
+        // Only async-signal-safe calls from here
+        if (wake_fd_ >= 0) {
+            uint64_t one = 1;
+            ssize_t ret = ::write(wake_fd_, &one, sizeof(one));
+            (void) ret;
+        }
+    }
+
+
+    //
+    // Private
+    //
+    void SudokuServer::setUp()
+    {
+        sockaddr_un addr;
+        ::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (socket_path_.size() >= sizeof(addr.sun_path))
+            throw ServerError("Socket path too long: " + socket_path_);
+        ::strcpy(addr.sun_path, socket_path_.c_str());
+
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd_ < 0)
+            throw ServerError(systemError("eventfd"));
+
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK |
+                              SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0)
+            throw ServerError(systemError("socket"));
+
+        // Replace the socket left by a previous server, never other files
+        struct stat st;
+        if (::stat(socket_path_.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+            ::unlink(socket_path_.c_str());
+
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr),
+                   sizeof(addr)) < 0)
+            throw ServerError(systemError("bind '" + socket_path_ + "'"));
+        bound_ = true;
+        if (::listen(listen_fd_, SOMAXCONN) < 0)
+            throw ServerError(systemError("listen"));
+
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0)
+            throw ServerError(systemError("epoll_create1"));
+
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u64 = LISTEN_ID;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev) < 0)
+            throw ServerError(systemError("epoll_ctl"));
+        ev.data.u64 = WAKE_ID;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) < 0)
+            throw ServerError(systemError("epoll_ctl"));
+
+        // Have a warm solver ready for every worker before the first client
+        SudokuSolver::defaultSolverPool().prewarm(num_workers_);
+
+        workers_done_ = false;
+        for (size_t i = 0; i < num_workers_; ++i)
+            workers_.push_back(std::thread(&SudokuServer::workerLoop, this));
+    }
+
+
+    void SudokuServer::tearDown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex_);
+            workers_done_ = true;
+            jobs_.clear();
+        }
+        jobs_cond_.notify_all();
+        for (size_t i = 0; i < workers_.size(); ++i)
+            workers_[i].join();
+        workers_.clear();
+        results_.clear();
+
+        while (!connections_.empty())
+            closeConnection(*connections_.begin()->second);
+
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+        }
+        if (bound_) {
+            ::unlink(socket_path_.c_str());
+            bound_ = false;
+        }
+        if (epoll_fd_ >= 0) {
+            ::close(epoll_fd_);
+            epoll_fd_ = -1;
+        }
+        if (wake_fd_ >= 0) {
+            ::close(wake_fd_);
+            wake_fd_ = -1;
+        }
+    }
+
+
+    void SudokuServer::acceptConnections()
+    {
+        while (true) {
+            int fd = ::accept4(listen_fd_, NULL, NULL,
+                               SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return;     // EAGAIN, or an aborted connection
+
+            Connection* conn = new Connection();
+            conn->id = next_connection_id_++;
+            conn->fd = fd;
+            conn->events = EPOLLIN;
+            conn->out_pos = 0;
+            conn->next_seq = 0;
+            conn->next_send = 0;
+            conn->read_closed = false;
+
+            epoll_event ev;
+            ev.events = conn->events;
+            ev.data.u64 = conn->id;
+            if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                ::close(fd);
+                delete conn;
+                continue;
+            }
+            connections_[conn->id] = conn;
+        }
+    }
+
+
+    void SudokuServer::readConnection(Connection& conn)
+    {
+        // A single read per event bounds the input kept per connection,
+        // epoll reports the socket again while there is more to read
+        char buffer[READ_SIZE];
+        ssize_t n;
+        do {
+            n = ::read(conn.fd, buffer, sizeof(buffer));
+        } while (n < 0 && errno == EINTR);
+
+        if (n > 0) {
+            conn.in.append(buffer, n);
+        } else if (n == 0) {
+            conn.read_closed = true;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            closeConnection(conn);
+            return;
+        }
+
+        parseRequests(conn);
+        writeConnection(conn);
+    }
+
+
+    void SudokuServer::parseRequests(Connection& conn)
+    {
+        std::vector<Job> jobs;
+        size_t pos = 0;
+
+        while (conn.inFlight() + jobs.size() < max_pipeline_) {
+            size_t end = conn.in.find('\n', pos);
+            if (end == std::string::npos)
+                break;
+
+            size_t length = end - pos;
+            if (length > 0 && conn.in[end - 1] == '\r')
+                --length;
+            if (length > 0) {
+                Job job;
+                job.connection_id = conn.id;
+                job.seq = conn.next_seq + jobs.size();
+                job.line.assign(conn.in, pos, length);
+                job.deadline = requestDeadline();
+                jobs.push_back(job);
+            }
+            pos = end + 1;
+        }
+        conn.in.erase(0, pos);
+
+        // A last request without end of line
+        if (conn.read_closed && !conn.in.empty() &&
+            conn.in.find('\n') == std::string::npos &&
+            conn.inFlight() + jobs.size() < max_pipeline_) {
+            Job job;
+            job.connection_id = conn.id;
+            job.seq = conn.next_seq + jobs.size();
+            job.line.swap(conn.in);
+            job.deadline = requestDeadline();
+            jobs.push_back(job);
+        }
+
+        if (conn.in.size() > max_line_length_ &&
+            conn.in.find('\n') == std::string::npos) {
+            // Answered in its turn, after the requests still in flight
+            // and the ones parsed above, then the connection is closed
+            const char* error = "ERROR line too long\n";
+            uint64_t seq = conn.next_seq + jobs.size();
+            if (seq == conn.next_send) {
+                conn.out += error;
+                ++conn.next_send;
+            } else {
+                conn.ready[seq] = error;
+            }
+            conn.next_seq += 1;
+            conn.in.clear();
+            conn.read_closed = true;
+        }
+
+        if (!jobs.empty()) {
+            conn.next_seq += jobs.size();
+            {
+                std::lock_guard<std::mutex> lock(jobs_mutex_);
+                jobs_.insert(jobs_.end(), jobs.begin(), jobs.end());
+            }
+            if (jobs.size() > 1)
+                jobs_cond_.notify_all();
+            else
+                jobs_cond_.notify_one();
+        }
+    }
+
+
+    void SudokuServer::writeConnection(Connection& conn)
+    {
+        while (conn.out_pos < conn.out.size()) {
+            ssize_t n = ::send(conn.fd, conn.out.data() + conn.out_pos,
+                               conn.out.size() - conn.out_pos, MSG_NOSIGNAL);
+            if (n > 0) {
+                conn.out_pos += n;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                closeConnection(conn);
+                return;
+            }
+        }
+
+        if (conn.out_pos == conn.out.size()) {
+            conn.out.clear();
+            conn.out_pos = 0;
+
+            if (conn.read_closed && conn.inFlight() == 0) {
+                closeConnection(conn);
+                return;
+            }
+        }
+
+        updateEvents(conn);
+    }
+
+
+    void SudokuServer::updateEvents(Connection& conn)
+    {
+        uint32_t events = 0;
+        if (!conn.read_closed && conn.inFlight() < max_pipeline_)
+            events |= EPOLLIN;
+        if (conn.out_pos < conn.out.size())
+            events |= EPOLLOUT;
+
+        if (events != conn.events) {
+            epoll_event ev;
+            ev.events = events;
+            ev.data.u64 = conn.id;
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+            conn.events = events;
+        }
+    }
+
+
+    void SudokuServer::closeConnection(Connection& conn)
+    {
+        // Results of its pending requests are dropped when they arrive
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, NULL);
+        ::close(conn.fd);
+        connections_.erase(conn.id);
+        delete &conn;
+    }
+
+
+    void SudokuServer::deliverResults()
+    {
+        std::vector<Result> results;
+        {
+            std::lock_guard<std::mutex> lock(results_mutex_);
+            results.swap(results_);
+        }
+
+        // Queue every result, then write each connection once
+        std::vector<uint64_t> touched;
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::map<uint64_t, Connection*>::iterator it =
+                connections_.find(results[i].connection_id);
+            if (it == connections_.end())
+                continue;
+
+            Connection& conn = *it->second;
+            if (results[i].seq == conn.next_send) {
+                conn.out += results[i].response;
+                ++conn.next_send;
+
+                std::map<uint64_t, std::string>::iterator next;
+                while (!conn.ready.empty() &&
+                       (next = conn.ready.begin())->first == conn.next_send) {
+                    conn.out += next->second;
+                    conn.ready.erase(next);
+                    ++conn.next_send;
+                }
+                touched.push_back(conn.id);
+            } else {
+                conn.ready[results[i].seq].swap(results[i].response);
+            }
+        }
+
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()),
+                      touched.end());
+
+        for (size_t i = 0; i < touched.size(); ++i) {
+            std::map<uint64_t, Connection*>::iterator it =
+                connections_.find(touched[i]);
+            if (it == connections_.end())
+                continue;
+
+            // Requests left in the buffer by the pipeline limit
+            Connection& conn = *it->second;
+            if (!conn.in.empty())
+                parseRequests(conn);
+            writeConnection(conn);
+        }
+    }
+
+
+    void SudokuServer::workerLoop()
+    {
+        SudokuSolver engine;
+        engine.setCache(cache_);
+        PuzzleRater rater;
+
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(jobs_mutex_);
+                while (!workers_done_ && jobs_.empty())
+                    jobs_cond_.wait(lock);
+                if (workers_done_)
+                    return;
+
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+
+            Result result;
+            result.connection_id = job.connection_id;
+            result.seq = job.seq;
+            result.response = respond(engine, rater, job.line,
+                                      job.deadline);
+
+            bool wake;
+            {
+                std::lock_guard<std::mutex> lock(results_mutex_);
+                wake = results_.empty();
+                results_.push_back(std::move(result));
+            }
+
+            // The loop drains all the results at once, one wake up is enough
+            if (wake) {
+                uint64_t one = 1;
+                ssize_t ret = ::write(wake_fd_, &one, sizeof(one));
+                (void) ret;
+            }
+        }
+    }
+
+
+    // Counts from now, the request has just been read
+    Deadline SudokuServer::requestDeadline() const
+    {
+        if (request_timeout_ > 0)
+            return Deadline(request_timeout_, &cancel_);
+        return Deadline(cancel_);
+    }
+
+    std::string SudokuServer::respond(SudokuSolver& engine,
+                                      PuzzleRater& rater,
+                                      const std::string& line,
+                                      const Deadline& deadline)
+    {
+        try {
+            if (line.compare(0, 5, "HINT ") == 0) {
+                PuzzleRater::Hint hint =
+                    rater.hint(Grid::fromString(line.substr(5)));
+                if (hint.row < 0)
+                    return "NOHINT\n";
+
+                std::ostringstream oss;
+                oss << "HINT " << hint.row + 1 << ' ' << hint.column + 1
+                    << ' ' << hint.value << ' '
+                    << PuzzleRater::techniqueName(hint.technique) << '\n';
+                return oss.str();
+            }
+
+            Grid puzzle = Grid::fromString(line);
+            Grid solution;
+
+            switch (engine.solve(puzzle, solution, deadline)) {
+                case Solver::SATISFIABLE:
+                    return "OK " + solution.toString() + "\n";
+                case Solver::UNSATISFIABLE:
+                    return "UNSAT\n";
+                case Solver::OUT_OF_MEMORY:
+                    return "ERROR out of memory\n";
+                default:
+                    return "UNKNOWN\n";
+            }
+        } catch (const std::invalid_argument& e) {
+            return std::string("ERROR ") + e.what() + "\n";
+        }
+    }
+
+}
@@ -0,0 +1,154 @@
+//
+// File: SudokuSession.cpp
+//
+
+#include "SudokuSession.hpp"
+
+
+namespace sudoku
+{
+    SudokuSession::SudokuSession(SolverPool& pool)
+        : solver_(pool),
+          grid_(),
+          result_(Solver::UNKNOWN),
+          solution_(),
+          solver_stats_(),
+          stats_()
+    { }
+
+
+    SudokuSession::~SudokuSession()
+    {
+        // The solver goes back to the pool with the default phases
+        solver_->resetPhases();
+    }
+
+
+    void SudokuSession::set(int row, int column, int value)
+    {
+        int old_value = grid_.getValue(row, column);
+        grid_.setValue(row, column, value);
+        stats_.edits += 1;
+
+        if (value == old_value)
+            return;
+        if (result_ == Solver::SATISFIABLE &&
+            solution_.getValueUnchecked(row, column) != value)
+            result_ = Solver::UNKNOWN;
+        else if (result_ == Solver::UNSATISFIABLE &&
+                 old_value != Grid::UNDEFINED_VALUE)
+            result_ = Solver::UNKNOWN;
+    }
+
+
+    void SudokuSession::clear(int row, int column)
+    {
+        int old_value = grid_.getValue(row, column);
+        grid_.setValueUnchecked(row, column, Grid::UNDEFINED_VALUE);
+        stats_.edits += 1;
+
+        if (old_value != Grid::UNDEFINED_VALUE &&
+            result_ == Solver::UNSATISFIABLE)
+            result_ = Solver::UNKNOWN;
+    }
+
+
+    void SudokuSession::reset(const Grid& grid)
+    {
+        // Still settled if every value agrees with the last solution
+        const Grid::Cells& cells = grid.getCells();
+        const Grid::Cells& solution = solution_.getCells();
+        bool settled = result_ == Solver::SATISFIABLE;
+        for (int i = 0; i < Grid::NUM_CELLS && settled; ++i) {
+            settled = cells[i] == Grid::UNDEFINED_VALUE ||
+                      cells[i] == solution[i];
+        }
+
+        grid_ = grid;
+        stats_.edits += 1;
+        if (!settled)
+            result_ = Solver::UNKNOWN;
+    }
+
+
+    const Grid& SudokuSession::grid() const
+    {
+        return grid_;
+    }
+
+
+    Solver::SOLVE_RESULT SudokuSession::solve(Grid& solution,
+                                              const Deadline& deadline)
+    {
+        stats_.solves += 1;
+        solver_stats_ = Solver::Stats();
+        if (result_ == Solver::UNKNOWN)
+            solveGrid(deadline);
+
+        Solver::SOLVE_RESULT res = result_;
+        if (res == Solver::SATISFIABLE)
+            solution = solution_;
+
+        // Nothing settled, the next solve starts over with the rules alone
+        if (res == Solver::OUT_OF_MEMORY) {
+            solver_->clear();
+            SudokuSolver::addRulesConstraints(*solver_);
+            result_ = Solver::UNKNOWN;
+        }
+        return res;
+    }
+
+
+    const Solver::Stats& SudokuSession::getSolverStats() const
+    {
+        return solver_stats_;
+    }
+
+
+    const SudokuSession::Stats& SudokuSession::stats() const
+    {
+        return stats_;
+    }
+
+
+    //
+    // Private
+    //
+    void SudokuSession::solveGrid(const Deadline& deadline)
+    {
+        if (!grid_.isValid()) {
+            result_ = Solver::UNSATISFIABLE;
+            return;
+        }
+
+        for (int i = 0; i < Grid::NUM_ROWS; ++i) {
+            for (int j = 0; j < Grid::NUM_COLUMNS; ++j) {
+                int value = grid_.getValueUnchecked(i, j);
+                if (value != Grid::UNDEFINED_VALUE)
+                    solver_->assume(SudokuSolver::
+                        getLiteralForRowColumnValue(i, j, value));
+            }
+        }
+
+        Solver::Stats before = solver_->stats();
+        result_ = solver_->solve(Solver::DEF_DECISION_LIMIT, deadline);
+        stats_.solver_calls += 1;
+
+        solver_stats_ = solver_->stats();
+        solver_stats_.decisions -= before.decisions;
+        solver_stats_.propagations -= before.propagations;
+        solver_stats_.conflicts -= before.conflicts;
+        solver_stats_.visits -= before.visits;
+        solver_stats_.seconds -= before.seconds;
+
+        if (result_ != Solver::SATISFIABLE)
+            return;
+
+        // The next solve starts from this solution
+        solver_->readModel(model_, SudokuSolver::NUM_LITERALS);
+        SudokuSolver::decodeModel(model_, solution_);
+        for (int i = 0; i < SudokuSolver::NUM_LITERALS; ++i)
+            solver_->setDefaultPhase(i + 1, model_[i]);
+    }
+
+}
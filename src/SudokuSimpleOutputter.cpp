@@ -3,13 +3,11 @@
 // File: SudokuFormattedOutputter.cpp
 //
 
-#include <iostream>
-
-#include "Sudoku.hpp"
+#include "Grid.hpp"
 #include "SudokuSimpleOutputter.hpp"
 
 
-namespace sudoku 
+namespace sudoku
 {
     SudokuSimpleOutputter::SudokuSimpleOutputter(std::ostream& out_stream)
         : SudokuOutputter(out_stream)
@@ -20,17 +18,19 @@ namespace sudoku
     { }
 
 
-    void SudokuSimpleOutputter::output(const Sudoku& sudoku)
+    void SudokuSimpleOutputter::output(const Grid& sudoku)
     {
-        std::ostream& os = getStream();
+        // Every row is "v v v v v v v v v\n", two bytes per cell
+        char* out = reserve(Grid::NUM_ROWS * Grid::NUM_COLUMNS * 2);
 
-        for (int i = 0; i < Sudoku::NUM_ROWS; ++i) {
-            for (int j = 0; j < Sudoku::NUM_COLUMNS; ++j) {
-                os << sudoku.getValue(i, j)
-                   << (j + 1 < Sudoku::NUM_COLUMNS ? " " : "");
+        for (int i = 0; i < Grid::NUM_ROWS; ++i) {
+            for (int j = 0; j < Grid::NUM_COLUMNS; ++j) {
+                *out++ = static_cast<char>('0' + sudoku.getValueUnchecked(i, j));
+                *out++ = (j + 1 < Grid::NUM_COLUMNS ? ' ' : '\n');
             }
-            os << std::endl;
         }
+
+        commit();
     }
-    
+
 }
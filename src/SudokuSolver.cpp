@@ -0,0 +1,406 @@
+//
+// File: SudokuSolver.cpp
+//
+
+#include <vector>
+
+#include "SudokuSolver.hpp"
+#include "Timer.hpp"
+
+
+namespace sudoku
+{
+    const int SudokuSolver::NUM_LITERALS;
+
+
+    SudokuSolver::SudokuSolver(SolverPool& pool)
+        : pool_(pool),
+          cache_(NULL),
+          solver_stats_(),
+          allocator_stats_(),
+          timings_()
+    { }
+
+
+    SudokuSolver::~SudokuSolver()
+    { }
+
+
+    Solver::SOLVE_RESULT SudokuSolver::solve(const Grid& puzzle,
+                                             Grid& solution,
+                                             const Deadline& deadline)
+    {
+        // Contradictory givens need neither the cache nor a solver
+        if (!puzzle.isValid()) {
+            solver_stats_ = Solver::Stats();
+            allocator_stats_ = Arena::Stats();
+            timings_ = Timings();
+            return Solver::UNSATISFIABLE;
+        }
+
+        SolutionCache::Key key;
+        if (cache_ != NULL) {
+            Solver::SOLVE_RESULT cached;
+            if (cache_->lookup(puzzle, key, cached, solution)) {
+                solver_stats_ = Solver::Stats();
+                allocator_stats_ = Arena::Stats();
+                timings_ = Timings();
+                return cached;
+            }
+        }
+
+        Timer timer;
+
+        SolverPool::Lease solver(pool_);
+        Solver::Stats before = solver->stats();
+        Arena::Stats arena_before = solver->allocatorStats();
+
+        addFixedValuesConstraints(*solver, puzzle);
+        timings_.encode = timer.lap();
+
+        Solver::SOLVE_RESULT res = solver->solve(
+            Solver::DEF_DECISION_LIMIT, deadline);
+        timings_.solve = timer.lap();
+
+        if (res == Solver::SATISFIABLE) {
+            solver->readModel(model_, NUM_LITERALS);
+            decodeModel(model_, solution);
+        }
+        timings_.extract = timer.lap();
+
+        // Keep only the work of this call, the solver goes back to the pool
+        solver_stats_ = solver->stats();
+        solver_stats_.decisions -= before.decisions;
+        solver_stats_.propagations -= before.propagations;
+        solver_stats_.conflicts -= before.conflicts;
+        solver_stats_.visits -= before.visits;
+        solver_stats_.seconds -= before.seconds;
+
+        allocator_stats_ = solver->allocatorStats();
+        allocator_stats_.allocations -= arena_before.allocations;
+        allocator_stats_.deallocations -= arena_before.deallocations;
+        allocator_stats_.resizes -= arena_before.resizes;
+        allocator_stats_.in_place_resizes -= arena_before.in_place_resizes;
+
+        if (cache_ != NULL)
+            cache_->insert(key, res, solution);
+
+        return res;
+    }
+
+
+    void SudokuSolver::setCache(SolutionCache* cache)
+    {
+        cache_ = cache;
+    }
+
+
+    const Solver::Stats& SudokuSolver::getSolverStats() const
+    {
+        return solver_stats_;
+    }
+
+
+    const Arena::Stats& SudokuSolver::getAllocatorStats() const
+    {
+        return allocator_stats_;
+    }
+
+
+    const SudokuSolver::Timings& SudokuSolver::getTimings() const
+    {
+        return timings_;
+    }
+
+
+    // Sudoku rules, loaded once in every pooled solver
+    void SudokuSolver::addRulesConstraints(Solver& solver)
+    {
+        addOnlyOneValuePerCellConstraints(solver);
+        addDontRepeatInColumnConstraints(solver);
+        addDontRepeatInRowConstraints(solver);
+        addDontRepeatInSubRegionConstraints(solver);
+    }
+
+    // Pool used by default
+    SolverPool& SudokuSolver::defaultSolverPool()
+    {
+        static SolverPool pool(&SudokuSolver::addRulesConstraints);
+        return pool;
+    }
+
+    // Decodes a solver model, the values of a cell are consecutive literals.
+    // The cells are replaced at once, setting them one by one over the
+    // values of another grid would repeat values and update the unit masks
+    // of the grid from scratch.
+    void SudokuSolver::decodeModel(const int8_t* model, Grid& grid)
+    {
+        Grid::Cells cells;
+        for (int i = 0; i < Grid::NUM_CELLS; ++i)
+        {
+            int value = Grid::UNDEFINED_VALUE;
+            for (int v = 0; v < Grid::MAX_VALUE; ++v)
+            {
+                if (model[v] > 0)
+                {
+                    value = v + Grid::MIN_VALUE;
+                    break;
+                }
+            }
+            cells[i] = static_cast<uint8_t>(value);
+            model += Grid::MAX_VALUE;
+        }
+        grid = Grid(cells);
+    }
+
+    Solver::SOLVE_RESULT SudokuSolver::explain(const Grid& puzzle,
+                                               Grid& conflict)
+    {
+        SolverPool::Lease solver(pool_);
+        addFixedValuesConstraints(*solver, puzzle);
+
+        Solver::SOLVE_RESULT res = solver->solve();
+        if (res != Solver::UNSATISFIABLE)
+            return res;
+
+        std::vector<int> literals = solver->minimalFailedAssumptions();
+        conflict = Grid();
+        for (size_t i = 0; i < literals.size(); ++i) {
+            ROWCOLUMNVALUE rcv = getRowColumnValueForLiteral(literals[i]);
+            conflict.setValueUnchecked(rcv.first.first, rcv.first.second,
+                                       rcv.second);
+        }
+        return res;
+    }
+
+
+    Solver::SOLVE_RESULT SudokuSolver::backbone(const Grid& puzzle,
+                                                Grid& forced)
+    {
+        SolverPool::Lease solver(pool_);
+        addFixedValuesConstraints(*solver, puzzle);
+
+        Solver::SOLVE_RESULT res = solver->solve();
+        if (res != Solver::SATISFIABLE)
+            return res;
+
+        // Literals of the values of the first solution that may be forced
+        const Grid::Cells& cells = puzzle.getCells();
+        std::vector<int> candidates;
+        solver->readModel(model_, NUM_LITERALS);
+        for (int i = 0; i < NUM_LITERALS; ++i) {
+            if (model_[i] > 0 &&
+                cells[i / Grid::MAX_VALUE] == Grid::UNDEFINED_VALUE)
+                candidates.push_back(i + 1);
+        }
+
+        std::vector<int> other_solution;
+        Solver::SOLVE_RESULT other = Solver::SATISFIABLE;
+        while (!candidates.empty() && other == Solver::SATISFIABLE) {
+            other_solution.clear();
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                other_solution.push_back(-candidates[i]);
+                solver->setDefaultPhase(candidates[i], -1);
+            }
+
+            solver->push();
+            solver->addClause(other_solution);
+            addFixedValuesConstraints(*solver, puzzle);
+            other = solver->solve();
+            if (other == Solver::SATISFIABLE) {
+                // Keep the values this solution agrees with
+                solver->readModel(model_, NUM_LITERALS);
+                size_t kept = 0;
+                for (size_t i = 0; i < candidates.size(); ++i) {
+                    if (model_[candidates[i] - 1] > 0)
+                        candidates[kept++] = candidates[i];
+                }
+                candidates.resize(kept);
+            }
+            solver->pop();
+        }
+        solver->resetPhases();
+        if (other != Solver::UNSATISFIABLE)
+            return other;
+
+        forced = puzzle;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            ROWCOLUMNVALUE rcv = getRowColumnValueForLiteral(candidates[i]);
+            forced.setValueUnchecked(rcv.first.first, rcv.first.second,
+                                     rcv.second);
+        }
+        return res;
+    }
+
+
+    SudokuSolver::MINIMALITY SudokuSolver::checkMinimal(const Grid& puzzle,
+                                                        Grid& redundant)
+    {
+        redundant = Grid();
+        if (!puzzle.isValid())
+            return NO_SOLUTION;
+
+        SolverPool::Lease solver(pool_);
+        addFixedValuesConstraints(*solver, puzzle);
+        if (solver->solve(-1) != Solver::SATISFIABLE)
+            return NO_SOLUTION;
+
+        const Grid::Cells& cells = puzzle.getCells();
+        std::vector<int> clues;
+        std::vector<int> other_solution;
+        solver->readModel(model_, NUM_LITERALS);
+        for (int i = 0; i < NUM_LITERALS; ++i) {
+            if (model_[i] <= 0)
+                continue;
+            other_solution.push_back(-(i + 1));
+            if (cells[i / Grid::MAX_VALUE] != Grid::UNDEFINED_VALUE)
+                clues.push_back(i + 1);
+        }
+
+        // Rules out the solution while the context is open
+        solver->push();
+        solver->addClause(other_solution);
+
+        for (size_t j = 0; j < clues.size(); ++j)
+            solver->assume(clues[j]);
+        MINIMALITY res = solver->solve(-1) == Solver::SATISFIABLE ?
+            NOT_UNIQUE : MINIMAL;
+
+        for (size_t k = 0; k < clues.size() && res != NOT_UNIQUE; ++k) {
+            for (size_t j = 0; j < clues.size(); ++j) {
+                if (j != k)
+                    solver->assume(clues[j]);
+            }
+            if (solver->solve(-1) == Solver::UNSATISFIABLE) {
+                ROWCOLUMNVALUE rcv = getRowColumnValueForLiteral(clues[k]);
+                redundant.setValueUnchecked(rcv.first.first,
+                                            rcv.first.second, rcv.second);
+                res = NOT_MINIMAL;
+            }
+        }
+
+        solver->pop();
+        return res;
+    }
+
+
+    // Literal of a (row, column, value) triplet
+    int SudokuSolver::getLiteralForRowColumnValue(int row, int column,
+                                                  int value)
+    {
+        return (row * Grid::NUM_COLUMNS + column) * Grid::MAX_VALUE + value;
+    }
+
+    // (row, column, value) triplet of a literal
+    SudokuSolver::ROWCOLUMNVALUE SudokuSolver::getRowColumnValueForLiteral(
+        int literal)
+    {
+        int cell = (literal - 1) / Grid::MAX_VALUE;
+        int value = (literal - 1) % Grid::MAX_VALUE + Grid::MIN_VALUE;
+        int row = cell / Grid::NUM_COLUMNS;
+        int column = cell % Grid::NUM_COLUMNS;
+        return std::make_pair(std::make_pair(row, column), value);
+    }
+
+
+    //
+    // Private
+    //
+    void SudokuSolver::addOnlyOneValuePerCellConstraints(Solver& solver)
+    {
+        std::vector<int> literals(Grid::MAX_VALUE, 0);
+
+        for (int i = 0; i < Grid::NUM_ROWS; ++i)
+        {
+            for (int j = 0; j < Grid::NUM_COLUMNS; ++j)
+            {
+                for (int vn = Grid::MIN_VALUE; vn <= Grid::MAX_VALUE; ++vn)
+                {
+                    literals[vn-Grid::MIN_VALUE] =
+                        getLiteralForRowColumnValue(i, j, vn);
+                }
+                solver.addExactlyOneConstraint(literals);
+            }
+        }
+    }
+
+    void SudokuSolver::addDontRepeatInColumnConstraints(Solver& solver)
+    {
+        std::vector<int> literals(Grid::NUM_ROWS, 0);
+        // All possible values per cell
+        for (int vn = Grid::MIN_VALUE; vn <= Grid::MAX_VALUE; ++vn)
+        {
+            for (int j = 0; j < Grid::NUM_COLUMNS; ++j)
+            {
+                for (int i = 0; i < Grid::NUM_ROWS; ++i)
+                {
+                    literals[i] = getLiteralForRowColumnValue(i, j, vn);
+                }
+                solver.addExactlyOneConstraint(literals);
+            }
+        }
+    }
+
+    void SudokuSolver::addDontRepeatInRowConstraints(Solver& solver)
+    {
+        std::vector<int> literals(Grid::NUM_COLUMNS, 0);
+        // All possible values per cell
+        for (int vn = Grid::MIN_VALUE; vn <= Grid::MAX_VALUE; ++vn)
+        {
+            for (int i = 0; i < Grid::NUM_ROWS; ++i)
+            {
+                for (int j = 0; j < Grid::NUM_COLUMNS; ++j)
+                {
+                    literals[j] = getLiteralForRowColumnValue(i, j, vn);
+                }
+                solver.addExactlyOneConstraint(literals);
+            }
+        }
+    }
+
+    void SudokuSolver::addDontRepeatInSubRegionConstraints(Solver& solver)
+    {
+        std::vector<int> literals(
+            Grid::SUBREGION_NUM_ROWS * Grid::SUBREGION_NUM_COLUMNS, 0);
+
+        for (int nv = Grid::MIN_VALUE; nv <= Grid::MAX_VALUE; ++nv)
+        {
+            for (int si = 0; si < Grid::NUM_ROWS;
+                 si += Grid::SUBREGION_NUM_ROWS)
+            {
+                for (int sj = 0; sj < Grid::NUM_COLUMNS;
+                     sj += Grid::SUBREGION_NUM_COLUMNS)
+                {
+                    int lit_index = -1;
+                    for (int i = si; i < si + Grid::SUBREGION_NUM_ROWS; ++i)
+                    {
+                        for (int j = sj;
+                             j < sj + Grid::SUBREGION_NUM_COLUMNS; ++j)
+                        {
+                            literals[++lit_index] =
+                                getLiteralForRowColumnValue(i, j, nv);
+                        }
+                    }
+                    solver.addExactlyOneConstraint(literals);
+                }
+            }
+        }
+    }
+
+    void SudokuSolver::addFixedValuesConstraints(Solver& solver,
+                                                 const Grid& puzzle)
+    {
+        for (int i = 0; i < Grid::NUM_ROWS; ++i)
+        {
+            for (int j = 0; j < Grid::NUM_COLUMNS; ++j)
+            {
+                if (puzzle.getValueUnchecked(i, j) != Grid::UNDEFINED_VALUE)
+                {
+                    int literal = getLiteralForRowColumnValue(
+                        i, j, puzzle.getValueUnchecked(i, j));
+                    solver.assume(literal);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,882 @@
+//
+// File: Symmetry.cpp
+//
+
+#include <cstring>
+
+#include <algorithm>
+#include <vector>
+
+#include "Symmetry.hpp"
+
+
+namespace sudoku
+{
+    namespace
+    {
+        // The permutations of three rows, columns, bands or stacks
+        const uint8_t PERMUTATIONS_3[6][3] = {
+            { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 },
+            { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+        };
+
+
+        // Columns of every stack, or stacks, that can be at any position
+        const uint8_t ALL_ORDERS = (1u << 6) - 1;
+
+
+        /**
+         * A prefix of the minimal form: the rows chosen so far and the
+         * column orders that give it. The orders are kept as sets, the
+         * stacks and the columns of every stack that have only been empty
+         * in the rows chosen are interchangeable until a later row tells
+         * them apart, and the sets are only split where the digits of the
+         * grid would take different labels.
+         */
+        struct Prefix
+        {
+            uint8_t transpose;
+            uint8_t num_rows;
+            uint16_t used_rows;
+            uint8_t rows[9];
+            uint8_t stack_orders;   // bits over PERMUTATIONS_3
+            uint8_t orders[3];      // of the columns of every stack
+            uint8_t labels[10];     // of the digits seen, 0 if not seen
+            uint8_t next_label;
+        };
+
+
+        /**
+         * Minimal lexicographic form, built one row at a time. All the
+         * prefixes that give the smallest rows so far are extended by every
+         * row allowed next, and only those that give the smallest next row
+         * are kept, so the search is exact with no backtracking.
+         */
+        class MinlexSearch
+        {
+        public:
+            MinlexSearch();
+
+            Grid run(const Grid& grid, Transform* transform);
+
+        private:
+            void extendRow(const Prefix& prefix, int row, int stack_order,
+                           int position, const uint8_t* labels,
+                           int next_label, uint8_t* orders);
+            void addPrefix(const Prefix& prefix, int row, int stack_order,
+                           const uint8_t* labels, int next_label,
+                           const uint8_t* orders);
+            Transform makeTransform(const Prefix& prefix) const;
+
+            uint8_t source_[2][9][9];   // the grid and its transposition
+            uint8_t empty_stacks_[2][9];    // of every row of source_
+
+            std::vector<Prefix> prefixes_;
+            std::vector<Prefix> next_prefixes_;
+            size_t merge_from_;         // first prefix of the current row
+
+            uint8_t row_[9];            // the row being extended
+            bool found_;
+            uint8_t best_row_[9];       // the smallest next row found
+            uint8_t best_[Grid::NUM_CELLS];
+        };
+
+
+        MinlexSearch::MinlexSearch()
+            : prefixes_(),
+              next_prefixes_(),
+              merge_from_(0),
+              found_(false)
+        { }
+
+
+        Grid MinlexSearch::run(const Grid& grid, Transform* transform)
+        {
+            for (int i = 0; i < 9; ++i) {
+                for (int j = 0; j < 9; ++j) {
+                    source_[0][i][j] = grid.getValueUnchecked(i, j);
+                    source_[1][j][i] = grid.getValueUnchecked(i, j);
+                }
+            }
+            for (int t = 0; t < 2; ++t) {
+                for (int i = 0; i < 9; ++i) {
+                    const uint8_t* cells = source_[t][i];
+                    empty_stacks_[t][i] = 0;
+                    for (int s = 0; s < 3; ++s) {
+                        if ((cells[3 * s] | cells[3 * s + 1] |
+                             cells[3 * s + 2]) == 0)
+                            ++empty_stacks_[t][i];
+                    }
+                }
+            }
+
+            prefixes_.clear();
+            for (int t = 0; t < 2; ++t) {
+                Prefix start;
+                ::memset(&start, 0, sizeof(start));
+                start.transpose = static_cast<uint8_t>(t);
+                start.stack_orders = ALL_ORDERS;
+                for (int s = 0; s < 3; ++s)
+                    start.orders[s] = ALL_ORDERS;
+                prefixes_.push_back(start);
+            }
+
+            for (int k = 0; k < 9; ++k) {
+                next_prefixes_.clear();
+                found_ = false;
+
+                for (size_t i = 0; i < prefixes_.size(); ++i) {
+                    const Prefix& prefix = prefixes_[i];
+
+                    // A new band starts every three rows
+                    int first_row = 0, last_row = 8;
+                    if (k % 3 != 0) {
+                        first_row = prefix.rows[k - 1] / 3 * 3;
+                        last_row = first_row + 2;
+                    }
+
+                    for (int r = first_row; r <= last_row; ++r) {
+                        unsigned band = 7u << (r / 3 * 3);
+                        if ((prefix.used_rows & (1u << r)) ||
+                            (k % 3 == 0 && (prefix.used_rows & band)))
+                            continue;
+
+                        merge_from_ = next_prefixes_.size();
+                        for (int so = 0; so < 6; ++so) {
+                            if (!(prefix.stack_orders & (1u << so)))
+                                continue;
+                            uint8_t orders[3];
+                            ::memcpy(orders, prefix.orders, sizeof(orders));
+                            extendRow(prefix, r, so, 0, prefix.labels,
+                                      prefix.next_label, orders);
+                        }
+                    }
+                }
+
+                ::memcpy(best_ + 9 * k, best_row_, sizeof(best_row_));
+                prefixes_.swap(next_prefixes_);
+            }
+
+            if (transform != NULL)
+                *transform = makeTransform(prefixes_.front());
+
+            Grid::Cells cells;
+            ::memcpy(cells.data(), best_, Grid::NUM_CELLS);
+            return Grid(cells);
+        }
+
+
+        // Places the stack at the given position of the row, with the
+        // column orders that give the smallest cells, and goes on with the
+        // next position once for every way of labeling the digits.
+        void MinlexSearch::extendRow(const Prefix& prefix, int row,
+                                     int stack_order, int position,
+                                     const uint8_t* labels, int next_label,
+                                     uint8_t* orders)
+        {
+            if (position == 3) {
+                addPrefix(prefix, row, stack_order, labels, next_label,
+                          orders);
+                return;
+            }
+
+            int stack = PERMUTATIONS_3[stack_order][position];
+            const uint8_t* cells =
+                source_[prefix.transpose][row] + 3 * stack;
+            uint8_t* out = row_ + 3 * position;
+
+            // Smallest cells over the column orders allowed
+            unsigned min_orders = 0;
+            for (unsigned left = orders[stack]; left != 0; left &= left - 1) {
+                int o = __builtin_ctz(left);
+
+                uint8_t block[3];
+                int label = next_label;
+                for (int c = 0; c < 3; ++c) {
+                    int v = cells[PERMUTATIONS_3[o][c]];
+                    if (v == 0 || labels[v] != 0) {
+                        block[c] = labels[v];
+                        continue;
+                    }
+                    // a repeated digit, only in grids that break the rules
+                    block[c] = 0;
+                    for (int d = 0; d < c; ++d) {
+                        if (cells[PERMUTATIONS_3[o][d]] == v)
+                            block[c] = block[d];
+                    }
+                    if (block[c] == 0)
+                        block[c] = static_cast<uint8_t>(++label);
+                }
+
+                int cmp = min_orders ? ::memcmp(block, out, 3) : -1;
+                if (cmp < 0) {
+                    ::memcpy(out, block, 3);
+                    min_orders = 0;
+                }
+                if (cmp <= 0)
+                    min_orders |= 1u << o;
+            }
+
+            if (found_ && ::memcmp(row_, best_row_, 3 * position + 3) > 0)
+                return;
+
+            // The orders that put the same columns in the cells with a
+            // digit label the grid alike, the others apart
+            uint8_t allowed = orders[stack];
+            while (min_orders != 0) {
+                int first = __builtin_ctz(min_orders);
+                unsigned same = 0;
+                for (int o = first; o < 6; ++o) {
+                    if (!(min_orders & (1u << o)))
+                        continue;
+                    bool equal = true;
+                    for (int c = 0; c < 3 && equal; ++c) {
+                        equal = out[c] == 0 || PERMUTATIONS_3[o][c] ==
+                                               PERMUTATIONS_3[first][c];
+                    }
+                    if (equal)
+                        same |= 1u << o;
+                }
+                min_orders &= ~same;
+
+                uint8_t next_labels[10];
+                ::memcpy(next_labels, labels, sizeof(next_labels));
+                int label = next_label;
+                for (int c = 0; c < 3; ++c) {
+                    int v = cells[PERMUTATIONS_3[first][c]];
+                    if (v != 0 && next_labels[v] == 0)
+                        next_labels[v] = static_cast<uint8_t>(++label);
+                }
+
+                orders[stack] = static_cast<uint8_t>(same);
+                extendRow(prefix, row, stack_order, position + 1,
+                          next_labels, label, orders);
+            }
+            orders[stack] = allowed;
+        }
+
+
+        void MinlexSearch::addPrefix(const Prefix& prefix, int row,
+                                     int stack_order, const uint8_t* labels,
+                                     int next_label, const uint8_t* orders)
+        {
+            int cmp = found_ ? ::memcmp(row_, best_row_, 9) : -1;
+            if (cmp > 0)
+                return;
+            if (cmp < 0) {
+                ::memcpy(best_row_, row_, sizeof(best_row_));
+                found_ = true;
+                next_prefixes_.clear();
+                merge_from_ = 0;
+            }
+
+            // The stack orders that only move stacks empty in the row share
+            // a prefix, that needs two of them
+            bool mergeable = empty_stacks_[prefix.transpose][row] >= 2;
+            for (size_t i = merge_from_;
+                 mergeable && i < next_prefixes_.size(); ++i) {
+                Prefix& other = next_prefixes_[i];
+                if (other.rows[prefix.num_rows] == row &&
+                    other.next_label == next_label &&
+                    ::memcmp(other.orders, orders, 3) == 0 &&
+                    ::memcmp(other.labels, labels, 10) == 0) {
+                    other.stack_orders |= static_cast<uint8_t>(
+                        1u << stack_order);
+                    return;
+                }
+            }
+
+            Prefix next = prefix;
+            next.rows[next.num_rows++] = static_cast<uint8_t>(row);
+            next.used_rows = static_cast<uint16_t>(
+                next.used_rows | (1u << row));
+            next.stack_orders = static_cast<uint8_t>(1u << stack_order);
+            ::memcpy(next.orders, orders, sizeof(next.orders));
+            ::memcpy(next.labels, labels, sizeof(next.labels));
+            next.next_label = static_cast<uint8_t>(next_label);
+            next_prefixes_.push_back(next);
+        }
+
+
+        Transform MinlexSearch::makeTransform(const Prefix& prefix) const
+        {
+            Transform t;
+            t.transpose = prefix.transpose != 0;
+            ::memcpy(t.rows, prefix.rows, sizeof(t.rows));
+
+            int stack_order = __builtin_ctz(prefix.stack_orders);
+            for (int p = 0; p < 3; ++p) {
+                int stack = PERMUTATIONS_3[stack_order][p];
+                int order = __builtin_ctz(prefix.orders[stack]);
+                for (int c = 0; c < 3; ++c) {
+                    t.columns[3 * p + c] = static_cast<uint8_t>(
+                        3 * stack + PERMUTATIONS_3[order][c]);
+                }
+            }
+
+            // Digits missing from the grid take the labels left, in order
+            bool taken[10] = { false };
+            t.digits[0] = 0;
+            for (int v = 1; v <= 9; ++v) {
+                t.digits[v] = prefix.labels[v];
+                taken[prefix.labels[v]] = true;
+            }
+            int label = 1;
+            for (int v = 1; v <= 9; ++v) {
+                if (t.digits[v] != 0)
+                    continue;
+                while (taken[label])
+                    ++label;
+                t.digits[v] = static_cast<uint8_t>(label);
+                taken[label] = true;
+            }
+            return t;
+        }
+
+
+        // Key of the lengths of the cycles of a permutation
+        constexpr uint32_t cycleKey(const char* lengths)
+        {
+            return *lengths == '\0' ? 0 :
+                (1u << (3 * (*lengths - '1'))) + cycleKey(lengths + 1);
+        }
+
+
+        // Smallest second row of a top band for every class of pairs of
+        // rows of a band: the lengths of the cycles of the permutation that
+        // takes every column of the first row to the one of the second with
+        // the same digit, and whether it takes every stack to a single one.
+        // Column orders keep both, so no pair of a class gives a smaller
+        // row. Found by trying all the permutations that take every column
+        // to another stack.
+        struct RowBound
+        {
+            uint32_t cycles;
+            bool pure;
+            uint8_t row[9];
+        };
+
+        const RowBound ROW_BOUNDS[] = {
+            { cycleKey("333"), true, { 4, 5, 6, 7, 8, 9, 1, 2, 3 } },
+            { cycleKey("36"), true, { 4, 5, 6, 7, 8, 9, 1, 3, 2 } },
+            { cycleKey("9"), true, { 4, 5, 6, 7, 8, 9, 2, 3, 1 } },
+            { cycleKey("225"), false, { 4, 5, 7, 1, 8, 9, 2, 3, 6 } },
+            { cycleKey("27"), false, { 4, 5, 7, 1, 8, 9, 2, 6, 3 } },
+            { cycleKey("2223"), false, { 4, 5, 7, 1, 8, 9, 3, 2, 6 } },
+            { cycleKey("234"), false, { 4, 5, 7, 1, 8, 9, 6, 2, 3 } },
+            { cycleKey("9"), false, { 4, 5, 7, 2, 8, 9, 1, 6, 3 } },
+            { cycleKey("45"), false, { 4, 5, 7, 2, 8, 9, 6, 1, 3 } },
+            { cycleKey("36"), false, { 4, 5, 7, 3, 8, 9, 6, 2, 1 } },
+            { cycleKey("333"), false, { 4, 5, 7, 8, 9, 3, 6, 1, 2 } }
+        };
+
+        const uint8_t NO_BOUND[9] = { 0 };
+
+
+        // A way to put the smallest band on top: the transposition, the
+        // rows of the band in order and the column at every position
+        struct TopBand
+        {
+            uint8_t transpose;
+            uint8_t rows[3];
+            uint8_t columns[9];
+        };
+
+
+        // The rows of a band in the order tried for the top, with the
+        // smallest second row they could give
+        struct BandOrder
+        {
+            uint8_t transpose;
+            uint8_t rows[3];
+            const uint8_t* bound;
+
+            bool operator<(const BandOrder& other) const
+            {
+                return ::memcmp(bound, other.bound, 9) < 0;
+            }
+        };
+
+
+        /**
+         * Minimal lexicographic form of a filled grid whose rows, columns
+         * and boxes hold every digit once. Its first row is always
+         * 123456789, so MinlexSearch ties on every column order; here the
+         * smallest top band is found first and the rest of the grid
+         * follows from it. The bands are tried by the smallest second row
+         * their class of rows could give, see ROW_BOUNDS, and the search
+         * stops at the first one that can not tie with the best.
+         *
+         * With the digits labeled by the first row, the second and third
+         * rows of a band are the permutations that take the columns of the
+         * first row to the ones with the same digit, conjugated by the
+         * column order. The order is built position by position and every
+         * column reached by the second row takes the smallest position
+         * left for it, so the search only branches where the rows tie. For
+         * every order that gives the smallest top band, the stabilizer of
+         * the band, the other two bands only need their rows sorted.
+         */
+        class FilledGridSearch
+        {
+        public:
+            FilledGridSearch();
+
+            // False if the grid is not filled or a row, column or box
+            // repeats a digit
+            bool run(const Grid& grid, Grid& result, Transform* transform);
+
+        private:
+            const uint8_t* rowBound(int transpose, int first,
+                                    int second) const;
+            void searchBand(int transpose, int first, int second, int third);
+            void placeColumn(int position);
+            void visitColumn(int position);
+            void addTopBand();
+            void completeGrid(const TopBand& top, uint8_t* cells,
+                              uint8_t* rows) const;
+
+            uint8_t source_[2][9][9];   // the grid and its transposition
+            uint8_t columns_of_[2][9][10];  // of every digit in every row
+
+            // The band being searched, the column of the first row with
+            // the digit of the second and third rows at every column
+            int transpose_;
+            uint8_t band_rows_[3];
+            uint8_t second_[9];
+            uint8_t third_[9];
+
+            // The column order built so far, -1 where it is not known yet
+            int8_t columns_[9];         // at every position
+            int8_t positions_[9];       // of every column
+            int8_t stacks_[3];          // at every position
+            int8_t new_stacks_[3];      // position of every stack
+
+            uint8_t rows_[18];          // second and third rows
+            bool found_;
+            uint8_t best_[18];
+            std::vector<TopBand> tops_; // the ones that give best_
+        };
+
+
+        // Sorts the three rows of a band, and the numbers of the rows
+        void sortBand(uint8_t* cells, uint8_t* rows)
+        {
+            uint8_t tmp[9];
+            for (int i = 1; i < 3; ++i) {
+                for (int k = i; k > 0 &&
+                     ::memcmp(cells + 9 * (k - 1), cells + 9 * k, 9) > 0; --k) {
+                    ::memcpy(tmp, cells + 9 * k, 9);
+                    ::memcpy(cells + 9 * k, cells + 9 * (k - 1), 9);
+                    ::memcpy(cells + 9 * (k - 1), tmp, 9);
+                    std::swap(rows[k], rows[k - 1]);
+                }
+            }
+        }
+
+
+        FilledGridSearch::FilledGridSearch()
+            : transpose_(0),
+              found_(false),
+              tops_()
+        { }
+
+
+        bool FilledGridSearch::run(const Grid& grid, Grid& result,
+                                   Transform* transform)
+        {
+            const Grid::Cells& cells = grid.getCells();
+            for (int i = 0; i < 9; ++i) {
+                for (int j = 0; j < 9; ++j) {
+                    source_[0][i][j] = cells[9 * i + j];
+                    source_[1][j][i] = cells[9 * i + j];
+                }
+            }
+            for (int t = 0; t < 2; ++t) {
+                for (int i = 0; i < 9; ++i) {
+                    unsigned digits = 0;
+                    for (int j = 0; j < 9; ++j) {
+                        int v = source_[t][i][j];
+                        digits |= 1u << v;
+                        columns_of_[t][i][v] = static_cast<uint8_t>(j);
+                    }
+                    if (digits != 0x3fe)
+                        return false;
+                }
+            }
+            for (int box = 0; box < 9; ++box) {
+                unsigned digits = 0;
+                for (int k = 0; k < 9; ++k) {
+                    digits |= 1u << source_[0][box / 3 * 3 + k / 3]
+                                           [box % 3 * 3 + k % 3];
+                }
+                if (digits != 0x3fe)
+                    return false;
+            }
+
+            // The bands that could give the smallest second row first,
+            // the ones that can not give the best one found are skipped
+            BandOrder orders[36];
+            int n = 0;
+            for (int t = 0; t < 2; ++t) {
+                for (int b = 0; b < 3; ++b) {
+                    for (int o = 0; o < 6; ++o) {
+                        BandOrder& order = orders[n++];
+                        order.transpose = static_cast<uint8_t>(t);
+                        for (int k = 0; k < 3; ++k) {
+                            order.rows[k] = static_cast<uint8_t>(
+                                3 * b + PERMUTATIONS_3[o][k]);
+                        }
+                        order.bound = rowBound(t, order.rows[0],
+                                               order.rows[1]);
+                    }
+                }
+            }
+            std::sort(orders, orders + n);
+
+            found_ = false;
+            tops_.clear();
+            for (int i = 0; i < n; ++i) {
+                if (found_ && ::memcmp(orders[i].bound, best_, 9) > 0)
+                    break;
+                searchBand(orders[i].transpose, orders[i].rows[0],
+                           orders[i].rows[1], orders[i].rows[2]);
+            }
+
+            // The rest of the grid is the smallest over the stabilizer
+            uint8_t rest[54], rest_rows[6];
+            uint8_t best_rest[54], best_rest_rows[6];
+            size_t best_top = 0;
+            for (size_t i = 0; i < tops_.size(); ++i) {
+                completeGrid(tops_[i], rest, rest_rows);
+                if (i == 0 || ::memcmp(rest, best_rest, 54) < 0) {
+                    ::memcpy(best_rest, rest, 54);
+                    ::memcpy(best_rest_rows, rest_rows, 6);
+                    best_top = i;
+                }
+            }
+
+            Grid::Cells minimal;
+            for (int j = 0; j < 9; ++j)
+                minimal[j] = static_cast<uint8_t>(j + 1);
+            ::memcpy(minimal.data() + 9, best_, 18);
+            ::memcpy(minimal.data() + 27, best_rest, 54);
+            result = Grid(minimal);
+
+            if (transform != NULL) {
+                const TopBand& top = tops_[best_top];
+                transform->transpose = top.transpose != 0;
+                ::memcpy(transform->rows, top.rows, 3);
+                ::memcpy(transform->rows + 3, best_rest_rows, 6);
+                ::memcpy(transform->columns, top.columns, 9);
+
+                const uint8_t* first = source_[top.transpose][top.rows[0]];
+                transform->digits[0] = 0;
+                for (int j = 0; j < 9; ++j) {
+                    int position = 0;
+                    while (top.columns[position] != j)
+                        ++position;
+                    transform->digits[first[j]] =
+                        static_cast<uint8_t>(position + 1);
+                }
+            }
+            return true;
+        }
+
+
+        const uint8_t* FilledGridSearch::rowBound(int transpose, int first,
+                                                  int second) const
+        {
+            const uint8_t* columns = columns_of_[transpose][first];
+            const uint8_t* row = source_[transpose][second];
+            uint8_t next[9];
+            for (int c = 0; c < 9; ++c)
+                next[c] = columns[row[c]];
+
+            bool pure = true;
+            for (int s = 0; s < 9; s += 3) {
+                pure = pure && next[s] / 3 == next[s + 1] / 3 &&
+                       next[s] / 3 == next[s + 2] / 3;
+            }
+
+            uint32_t cycles = 0;
+            unsigned seen = 0;
+            for (int c = 0; c < 9; ++c) {
+                int length = 0;
+                for (int k = c; !(seen & (1u << k)); k = next[k]) {
+                    seen |= 1u << k;
+                    ++length;
+                }
+                if (length > 0)
+                    cycles += 1u << (3 * (length - 1));
+            }
+
+            for (size_t i = 0; i < sizeof(ROW_BOUNDS) / sizeof(RowBound);
+                 ++i) {
+                if (ROW_BOUNDS[i].cycles == cycles &&
+                    ROW_BOUNDS[i].pure == pure)
+                    return ROW_BOUNDS[i].row;
+            }
+            return NO_BOUND;
+        }
+
+
+        void FilledGridSearch::searchBand(int transpose, int first,
+                                          int second, int third)
+        {
+            transpose_ = transpose;
+            band_rows_[0] = static_cast<uint8_t>(first);
+            band_rows_[1] = static_cast<uint8_t>(second);
+            band_rows_[2] = static_cast<uint8_t>(third);
+
+            const uint8_t* columns = columns_of_[transpose][first];
+            for (int c = 0; c < 9; ++c) {
+                second_[c] = columns[source_[transpose][second][c]];
+                third_[c] = columns[source_[transpose][third][c]];
+            }
+
+            ::memset(columns_, -1, sizeof(columns_));
+            ::memset(positions_, -1, sizeof(positions_));
+            ::memset(stacks_, -1, sizeof(stacks_));
+            ::memset(new_stacks_, -1, sizeof(new_stacks_));
+            placeColumn(0);
+        }
+
+
+        // Tries every column that can go at the position, unless a
+        // previous one already took it
+        void FilledGridSearch::placeColumn(int position)
+        {
+            if (position == 9) {
+                addTopBand();
+                return;
+            }
+            if (columns_[position] >= 0) {
+                visitColumn(position);
+                return;
+            }
+
+            // The first position of a stack chooses it
+            int new_stack = position / 3;
+            int stack = stacks_[new_stack];
+            for (int c = 0; c < 9; ++c) {
+                if (positions_[c] >= 0)
+                    continue;
+                if (stack < 0 ? new_stacks_[c / 3] >= 0 : c / 3 != stack)
+                    continue;
+
+                columns_[position] = static_cast<int8_t>(c);
+                positions_[c] = static_cast<int8_t>(position);
+                if (stack < 0) {
+                    stacks_[new_stack] = static_cast<int8_t>(c / 3);
+                    new_stacks_[c / 3] = static_cast<int8_t>(new_stack);
+                }
+
+                visitColumn(position);
+
+                if (stack < 0) {
+                    stacks_[new_stack] = -1;
+                    new_stacks_[c / 3] = -1;
+                }
+                columns_[position] = -1;
+                positions_[c] = -1;
+            }
+        }
+
+
+        // Labels the cell of the second row at the position, placing the
+        // column of its digit as soon as it can go, and goes on if the row
+        // is still not larger than the best one
+        void FilledGridSearch::visitColumn(int position)
+        {
+            int target = second_[columns_[position]];
+            int placed = -1;
+            bool opens = false;
+            if (positions_[target] < 0) {
+                int stack = target / 3;
+                int new_stack = new_stacks_[stack];
+                opens = new_stack < 0;
+                if (opens) {
+                    new_stack = 0;
+                    while (stacks_[new_stack] >= 0)
+                        ++new_stack;
+                    stacks_[new_stack] = static_cast<int8_t>(stack);
+                    new_stacks_[stack] = static_cast<int8_t>(new_stack);
+                }
+                placed = 3 * new_stack;
+                while (columns_[placed] >= 0)
+                    ++placed;
+                columns_[placed] = static_cast<int8_t>(target);
+                positions_[target] = static_cast<int8_t>(placed);
+            }
+
+            rows_[position] = static_cast<uint8_t>(positions_[target] + 1);
+            int cmp = 0;
+            for (int p = 0; found_ && cmp == 0 && p <= position; ++p)
+                cmp = rows_[p] - best_[p];
+            if (cmp <= 0)
+                placeColumn(position + 1);
+
+            if (placed >= 0) {
+                if (opens) {
+                    stacks_[placed / 3] = -1;
+                    new_stacks_[target / 3] = -1;
+                }
+                columns_[placed] = -1;
+                positions_[target] = -1;
+            }
+        }
+
+
+        void FilledGridSearch::addTopBand()
+        {
+            for (int p = 0; p < 9; ++p) {
+                rows_[9 + p] = static_cast<uint8_t>(
+                    positions_[third_[columns_[p]]] + 1);
+            }
+
+            int cmp = found_ ? ::memcmp(rows_, best_, sizeof(best_)) : -1;
+            if (cmp > 0)
+                return;
+            if (cmp < 0) {
+                ::memcpy(best_, rows_, sizeof(best_));
+                found_ = true;
+                tops_.clear();
+            }
+
+            TopBand top;
+            top.transpose = static_cast<uint8_t>(transpose_);
+            ::memcpy(top.rows, band_rows_, sizeof(top.rows));
+            for (int p = 0; p < 9; ++p)
+                top.columns[p] = static_cast<uint8_t>(columns_[p]);
+            tops_.push_back(top);
+        }
+
+
+        // The two other bands with their rows sorted, the smallest first
+        void FilledGridSearch::completeGrid(const TopBand& top,
+                                            uint8_t* cells,
+                                            uint8_t* rows) const
+        {
+            const uint8_t (*source)[9] = source_[top.transpose];
+            const uint8_t* first = columns_of_[top.transpose][top.rows[0]];
+            uint8_t positions[9];
+            for (int p = 0; p < 9; ++p)
+                positions[top.columns[p]] = static_cast<uint8_t>(p);
+
+            uint8_t bands[2][27], band_rows[2][3];
+            int n = 0;
+            for (int b = 0; b < 3; ++b) {
+                if (b == top.rows[0] / 3)
+                    continue;
+                for (int k = 0; k < 3; ++k) {
+                    const uint8_t* row = source[3 * b + k];
+                    for (int p = 0; p < 9; ++p) {
+                        bands[n][9 * k + p] = static_cast<uint8_t>(
+                            positions[first[row[top.columns[p]]]] + 1);
+                    }
+                    band_rows[n][k] = static_cast<uint8_t>(3 * b + k);
+                }
+                sortBand(bands[n], band_rows[n]);
+                ++n;
+            }
+
+            int low = (::memcmp(bands[0], bands[1], 27) <= 0) ? 0 : 1;
+            ::memcpy(cells, bands[low], 27);
+            ::memcpy(cells + 27, bands[1 - low], 27);
+            ::memcpy(rows, band_rows[low], 3);
+            ::memcpy(rows + 3, band_rows[1 - low], 3);
+        }
+    }
+
+
+    //--------
+
+    Transform Transform::identity()
+    {
+        Transform t;
+        t.transpose = false;
+        for (int i = 0; i < 9; ++i) {
+            t.rows[i] = static_cast<uint8_t>(i);
+            t.columns[i] = static_cast<uint8_t>(i);
+        }
+        for (int v = 0; v <= 9; ++v)
+            t.digits[v] = static_cast<uint8_t>(v);
+        return t;
+    }
+
+
+    Transform Transform::random(std::mt19937& random)
+    {
+        Transform t;
+        t.transpose = (random() & 1) != 0;
+
+        uint8_t bands[3] = { 0, 1, 2 };
+        uint8_t stacks[3] = { 0, 1, 2 };
+        std::shuffle(bands, bands + 3, random);
+        std::shuffle(stacks, stacks + 3, random);
+        for (int b = 0; b < 3; ++b) {
+            uint8_t rows[3] = { 0, 1, 2 };
+            uint8_t columns[3] = { 0, 1, 2 };
+            std::shuffle(rows, rows + 3, random);
+            std::shuffle(columns, columns + 3, random);
+            for (int k = 0; k < 3; ++k) {
+                t.rows[3 * b + k] =
+                    static_cast<uint8_t>(3 * bands[b] + rows[k]);
+                t.columns[3 * b + k] =
+                    static_cast<uint8_t>(3 * stacks[b] + columns[k]);
+            }
+        }
+
+        for (int v = 0; v <= 9; ++v)
+            t.digits[v] = static_cast<uint8_t>(v);
+        std::shuffle(t.digits + 1, t.digits + 10, random);
+        return t;
+    }
+
+
+    Grid Transform::apply(const Grid& grid) const
+    {
+        Grid result;
+        for (int i = 0; i < 9; ++i) {
+            for (int j = 0; j < 9; ++j) {
+                int value = transpose
+                    ? grid.getValueUnchecked(columns[j], rows[i])
+                    : grid.getValueUnchecked(rows[i], columns[j]);
+                result.setValueUnchecked(i, j, digits[value]);
+            }
+        }
+        return result;
+    }
+
+
+    Transform Transform::inverse() const
+    {
+        Transform t;
+        t.transpose = transpose;
+
+        // Undo the permutations, the transposition swaps their roles
+        uint8_t* inv_rows = transpose ? t.columns : t.rows;
+        uint8_t* inv_columns = transpose ? t.rows : t.columns;
+        for (int i = 0; i < 9; ++i) {
+            inv_rows[rows[i]] = static_cast<uint8_t>(i);
+            inv_columns[columns[i]] = static_cast<uint8_t>(i);
+        }
+        for (int v = 0; v <= 9; ++v)
+            t.digits[digits[v]] = static_cast<uint8_t>(v);
+        return t;
+    }
+
+
+    Grid canonicalize(const Grid& grid, Transform* transform)
+    {
+        // Keeps the buffers of the searches between calls
+        static thread_local FilledGridSearch filled_search;
+        static thread_local MinlexSearch search;
+
+        Grid result;
+        if (filled_search.run(grid, result, transform))
+            return result;
+        return search.run(grid, transform);
+    }
+
+}
@@ -1,17 +1,41 @@
+#include <csignal>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iomanip>
 #include <iostream>
 #include <fstream>
 #include <limits>
+#include <mutex>
 #include <sstream>
 
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
+#include "Deadline.hpp"
+#include "GridSampler.hpp"
+#include "Histogram.hpp"
+#include "PuzzleGenerator.hpp"
+#include "PuzzleRater.hpp"
+#include "SolutionCache.hpp"
 #include "Sudoku.hpp"
 #include "SudokuOutputter.hpp"
+#include "SudokuReader.hpp"
 #include "SudokuFormattedOutputter.hpp"
+#include "SudokuJsonOutputter.hpp"
+#include "SudokuJsonReader.hpp"
+#include "SudokuLineOutputter.hpp"
+#include "SudokuBinaryOutputter.hpp"
+#include "SudokuNullOutputter.hpp"
+#include "SudokuServer.hpp"
 #include "SudokuSimpleOutputter.hpp"
+#include "Symmetry.hpp"
+#include "Timer.hpp"
 
 
 using namespace sudoku;
@@ -29,26 +53,145 @@ struct Options
     bool help;
     bool verbose;
     bool simple_output;
+    bool line_output;
+    bool pairs_output;
+    bool null_output;
+    bool binary_output;
+    bool stats;
+    bool timings;
+    bool canonicalize;
+    bool rate;
+    bool hint;
+    bool explain;
+    bool check_minimal;
+    bool jsonl;
+    size_t generate;
+    unsigned long seed;
+    PuzzleGenerator::Filter filter;
+    size_t sample;
+    GridSampler::Method sampler;
+    bool shuffle;
     std::string file_path;
+    std::string serve_path;
+    size_t workers;
+    size_t cache_size;
+    double timeout;                     // seconds per sudoku, 0 if none
+    size_t memory_budget;               // bytes per solver, 0 if none
 };
 
 
-class IOError : public std::runtime_error
+// State shared by the threads of --generate
+struct GeneratorRun
 {
-public:
-    IOError(const std::string& what) : std::runtime_error(what) { }
+    PuzzleGenerator::Filter filter;
+    size_t count;
+    bool pairs;                         // print the solutions too
+    std::atomic<size_t> claimed;        // puzzles taken by a thread
+
+    std::mutex mutex;                   // guards the members below
+    SudokuOutputter* outputter;
+    PuzzleGenerator::Stats stats;
+};
+
+
+// State shared by the threads of --sample
+struct SamplerRun
+{
+    GridSampler::Method method;
+    bool shuffle;
+    size_t count;
+    std::atomic<size_t> claimed;        // grids taken by a thread
+
+    std::mutex mutex;                   // guards the members below
+    SudokuOutputter* outputter;
+    GridSampler::Stats stats;
+    std::string error;                  // of the first thread that failed
+};
+
+
+// Solver counters and phase timings of all the sudokus solved in a run
+struct RunSummary
+{
+    size_t sudokus;
+    Solver::Stats total;
+    Solver::Stats max;
+    Arena::Stats arena_total;
+    Arena::Stats arena_max;
+
+    Histogram parse;
+    Histogram encode;
+    Histogram solve;
+    Histogram extract;
+    Histogram format;
 };
 
 
+// Constants
+// --------------------------------------------------------
+
+// Bytes of formatted grids kept before writing them when solving a batch
+const size_t BATCH_OUTPUT_BUFFER_SIZE = 64 * 1024;
+
+// Grids read for every worker before canonicalizing them in parallel
+const size_t CANONICALIZE_BATCH_SIZE = 1024;
+
+// Grids read for every worker before rating them in parallel
+const size_t RATE_BATCH_SIZE = 256;
+
+// Grids read for every worker before checking them in parallel
+const size_t CHECK_BATCH_SIZE = 64;
+
+// Grids sampled by a worker before writing them
+const size_t SAMPLE_BATCH_SIZE = 256;
+
+
+// Globals
+// --------------------------------------------------------
+
+// Server stopped by SIGINT and SIGTERM
+SudokuServer* running_server = NULL;
+
+
 // Function prototypes
 // --------------------------------------------------------
 void runSudokuSolver(const Options& opts);
+int runJsonSolver(const Options& opts);
+int runServer(const Options& opts);
+int runCanonicalizer(const Options& opts);
+int runGenerator(const Options& opts);
+void generatePuzzles(GeneratorRun& run, unsigned long seed);
+int runSampler(const Options& opts);
+void sampleGrids(SamplerRun& run, unsigned long seed);
+void canonicalizeGrids(std::vector<Grid>& grids, size_t begin, size_t end);
+int runRater(const Options& opts);
+int runHinter(const Options& opts);
+int runMinimalityChecker(const Options& opts);
+void rateGrids(const std::vector<Grid>& grids,
+               std::vector<PuzzleRater::Rating>& ratings, size_t begin,
+               size_t end);
+void checkGrids(const std::vector<Grid>& grids,
+                std::vector<SudokuSolver::MINIMALITY>& results,
+                std::vector<Grid>& redundant, size_t begin, size_t end);
+void stopServer(int signum);
+void solveSudoku(const Options&, SudokuSolver&, Sudoku&, SudokuOutputter&,
+                 RunSummary&, double parse_seconds);
+void explainConflict(SudokuSolver& engine, const Grid& puzzle);
+void printClues(std::ostream& os, const Grid& clues);
 Options readParameters(int argc, char *argv[]);
 SudokuOutputter* createSudokuOutputter(const Options& opts, std::ostream& os);
+SudokuOutputter* createGridOutputter(const Options& opts, std::ostream& os);
 
 void printHelp(const char* bin_path);
-void loadSudoku(const Options&, Sudoku&);
-void loadSudoku(std::istream&, Sudoku&);
+std::istream& openInput(const Options&, std::ifstream&);
+
+void addStats(RunSummary&, const Solver::Stats&, const Arena::Stats&);
+void printStats(std::ostream&, size_t sudoku_num, const Solver::Stats&,
+                const Arena::Stats&);
+void printStatsSummary(std::ostream&, const RunSummary&);
+void printCacheStats(std::ostream&, const SolutionCache::Stats&);
+void printTimings(std::ostream&, size_t sudoku_num, double parse,
+                  const Sudoku::Timings&, double format);
+void printTimingsSummary(std::ostream&, const RunSummary&);
 
 
 // Local utility inline functions
@@ -74,6 +217,25 @@ int main(int argc, char *argv[])
         return EXIT_SUCCESS;
     }
 
+    SudokuSolver::defaultSolverPool().setMemoryBudget(opts.memory_budget);
+
+    if (!opts.serve_path.empty())
+        return runServer(opts);
+    if (opts.canonicalize)
+        return runCanonicalizer(opts);
+    if (opts.rate)
+        return runRater(opts);
+    if (opts.hint)
+        return runHinter(opts);
+    if (opts.check_minimal)
+        return runMinimalityChecker(opts);
+    if (opts.generate > 0)
+        return runGenerator(opts);
+    if (opts.sample > 0)
+        return runSampler(opts);
+    if (opts.jsonl)
+        return runJsonSolver(opts);
+
     runSudokuSolver(opts);
     return EXIT_SUCCESS;
 }
@@ -82,39 +244,837 @@ int main(int argc, char *argv[])
 void runSudokuSolver(const Options& opts)
 {
     SudokuOutputter* outputter = createSudokuOutputter(opts, std::cout);
+    RunSummary summary = RunSummary();
 
-    try {
-        Sudoku sudoku;
-        loadSudoku(opts, sudoku);
+    SolutionCache* cache = NULL;
+    if (opts.cache_size > 0)
+        cache = new SolutionCache(opts.cache_size);
+    SudokuSolver engine;
+    engine.setCache(cache);
 
-        if (opts.verbose) {
-            outputter->output(sudoku);
-            std::cout << "/**" << std::endl << " * Solving ..."
-                      << std::endl << " */" << std::endl;
-        }
+    try {
+        std::ifstream file;
+        SudokuReader reader(openInput(opts, file));
 
-        Solver::SOLVE_RESULT solve_res = sudoku.solve();
+        if (reader.isLineFormat()) {
+            // One sudoku per line, a bad line does not stop the batch
+            outputter->setBufferSize(BATCH_OUTPUT_BUFFER_SIZE);
 
-        switch(solve_res) {
-            case Solver::SATISFIABLE:
-                outputter->output(sudoku);
-                break;
-            case Solver::UNSATISFIABLE:
-                std::cout << "Error: There is no solution for the given sudoku"
-                          << std::endl;
-                break;
-            default:
-                std::cout << "Error: Unexpectd solver result" << std::endl;
-                break;
+            bool more = true;
+            while (more) {
+                try {
+                    Sudoku sudoku;
+                    Timer parse_timer;
+                    more = reader.read(sudoku);
+                    if (more)
+                        solveSudoku(opts, engine, sudoku, *outputter,
+                                    summary, parse_timer.elapsed());
+                } catch (const IOError& e) {
+                    outputter->flush();
+                    std::cout << "Error: IO error '" << e.what() << "'"
+                              << std::endl;
+                } catch (const std::out_of_range& e) {
+                    outputter->flush();
+                    std::cout << "Error: Line " << reader.getLineNumber()
+                              << ": " << e.what() << std::endl;
+                }
+            }
+        } else {
+            Sudoku sudoku;
+            Timer parse_timer;
+            reader.read(sudoku);
+            solveSudoku(opts, engine, sudoku, *outputter, summary,
+                        parse_timer.elapsed());
         }
 
     } catch (const IOError& e) {
+        outputter->flush();
         std::cout << "Error: IO error '" << e.what() << "'" << std::endl;
     } catch (const std::out_of_range& e) {
+        outputter->flush();
         std::cout << "Error: " << e.what() << std::endl;
     }
 
+    outputter->flush();
     delete outputter;
+
+    if (opts.stats) {
+        printStatsSummary(std::cerr, summary);
+        if (cache != NULL)
+            printCacheStats(std::cerr, cache->stats());
+    }
+    if (opts.timings)
+        printTimingsSummary(std::cerr, summary);
+
+    delete cache;
+}
+
+
+void solveSudoku(const Options& opts, SudokuSolver& engine, Sudoku& sudoku,
+                 SudokuOutputter& outputter, RunSummary& summary,
+                 double parse_seconds)
+{
+    if (opts.verbose) {
+        outputter.output(sudoku);
+        outputter.flush();
+        std::cout << "/**" << std::endl << " * Solving ..."
+                  << std::endl << " */" << std::endl;
+    }
+
+    // Pairs need the puzzle once it has been solved, copies are cheap
+    const Grid puzzle(sudoku);
+
+    Solver::SOLVE_RESULT solve_res = sudoku.solve(
+        engine, opts.timeout > 0 ? Deadline(opts.timeout) : Deadline());
+
+    summary.sudokus += 1;
+    if (opts.stats) {
+        Solver::Stats stats = sudoku.getSolverStats();
+        const Arena::Stats& arena_stats = sudoku.getAllocatorStats();
+        addStats(summary, stats, arena_stats);
+        printStats(std::cerr, summary.sudokus, stats, arena_stats);
+    }
+
+    double format_seconds = 0;
+    switch(solve_res) {
+        case Solver::SATISFIABLE: {
+            Timer format_timer;
+            if (opts.pairs_output)
+                outputter.output(puzzle, sudoku);
+            else
+                outputter.output(sudoku);
+            format_seconds = format_timer.elapsed();
+            break;
+        }
+        case Solver::UNSATISFIABLE:
+            outputter.flush();
+            std::cout << "Error: There is no solution for the given sudoku";
+            try {
+                puzzle.validate();
+            } catch (const std::invalid_argument& e) {
+                std::cout << ", " << e.what();
+            }
+            std::cout << std::endl;
+            if (opts.explain)
+                explainConflict(engine, puzzle);
+            break;
+        case Solver::OUT_OF_MEMORY:
+            outputter.flush();
+            std::cout << "Error: The solver ran out of memory for the given "
+                      << "sudoku" << std::endl;
+            break;
+        case Solver::UNKNOWN:
+            // The deadline expired, or the decision limit without one
+            outputter.flush();
+            if (opts.timeout > 0)
+                std::cout << "Error: The time limit was reached solving the "
+                          << "given sudoku" << std::endl;
+            else
+                std::cout << "Error: The solver gave up on the given sudoku"
+                          << std::endl;
+            break;
+        default:
+            outputter.flush();
+            std::cout << "Error: Unexpectd solver result" << std::endl;
+            break;
+    }
+
+    if (opts.timings) {
+        const Sudoku::Timings& timings = sudoku.getTimings();
+        summary.parse.add(parse_seconds);
+        summary.encode.add(timings.encode);
+        summary.solve.add(timings.solve);
+        summary.extract.add(timings.extract);
+        if (solve_res == Solver::SATISFIABLE)
+            summary.format.add(format_seconds);
+
+        if (opts.verbose)
+            printTimings(std::cerr, summary.sudokus, parse_seconds, timings,
+                         format_seconds);
+    }
+}
+
+
+// Answers every JSON Lines record of the input with another one
+int runJsonSolver(const Options& opts)
+{
+    std::ifstream file;
+    std::istream* in_stream = NULL;
+    try {
+        in_stream = &openInput(opts, file);
+    } catch (const IOError& e) {
+        std::cerr << "Error: IO error '" << e.what() << "'" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    SudokuJsonOutputter outputter(std::cout);
+    outputter.setBufferSize(BATCH_OUTPUT_BUFFER_SIZE);
+    RunSummary summary = RunSummary();
+
+    SolutionCache* cache = NULL;
+    if (opts.cache_size > 0)
+        cache = new SolutionCache(opts.cache_size);
+    SudokuSolver engine;
+    engine.setCache(cache);
+
+    SudokuJsonReader reader(*in_stream);
+    SudokuJsonReader::Record input;
+    Grid solution;
+
+    // A bad record is answered with an error, it does not stop the batch
+    bool more = true;
+    while (more) {
+        SudokuJsonOutputter::Record output = SudokuJsonOutputter::Record();
+        std::string error;
+        Timer parse_timer;
+        try {
+            more = reader.read(input);
+        } catch (const IOError& e) {
+            error = e.what();
+        }
+        if (!more)
+            break;
+
+        output.id = input.id;
+        output.id_length = input.id_length;
+        output.parse = parse_timer.elapsed();
+        if (!error.empty()) {
+            output.error = error.c_str();
+            outputter.output(output);
+            continue;
+        }
+
+        output.result = engine.solve(input.puzzle, solution,
+            opts.timeout > 0 ? Deadline(opts.timeout) : Deadline());
+        output.solution = &solution;
+
+        summary.sudokus += 1;
+        if (opts.stats) {
+            output.stats = &engine.getSolverStats();
+            addStats(summary, engine.getSolverStats(),
+                     engine.getAllocatorStats());
+        }
+        if (opts.timings) {
+            const SudokuSolver::Timings& timings = engine.getTimings();
+            output.timings = &timings;
+            summary.parse.add(output.parse);
+            summary.encode.add(timings.encode);
+            summary.solve.add(timings.solve);
+            summary.extract.add(timings.extract);
+        }
+
+        Timer format_timer;
+        outputter.output(output);
+        if (opts.timings)
+            summary.format.add(format_timer.elapsed());
+    }
+    outputter.flush();
+
+    if (opts.stats) {
+        printStatsSummary(std::cerr, summary);
+        if (cache != NULL)
+            printCacheStats(std::cerr, cache->stats());
+    }
+    if (opts.timings)
+        printTimingsSummary(std::cerr, summary);
+
+    delete cache;
+    return EXIT_SUCCESS;
+}
+
+
+// Prints the minimal subset of the values of puzzle that has no solution
+void explainConflict(SudokuSolver& engine, const Grid& puzzle)
+{
+    Grid conflict;
+    if (engine.explain(puzzle, conflict) != Solver::UNSATISFIABLE)
+        return;
+
+    std::cout << "Conflicting clues:";
+    printClues(std::cout, conflict);
+    std::cout << std::endl;
+}
+
+
+// " <row> <column> <value>, ..." of the values of the grid
+void printClues(std::ostream& os, const Grid& clues)
+{
+    const char* separator = " ";
+    for (int i = 0; i < Grid::NUM_ROWS; ++i) {
+        for (int j = 0; j < Grid::NUM_COLUMNS; ++j) {
+            int value = clues.getValueUnchecked(i, j);
+            if (value != Grid::UNDEFINED_VALUE) {
+                os << separator << i + 1 << ' ' << j + 1 << ' ' << value;
+                separator = ", ";
+            }
+        }
+    }
+}
+
+
+int runServer(const Options& opts)
+{
+    SolutionCache* cache = NULL;
+    if (opts.cache_size > 0)
+        cache = new SolutionCache(opts.cache_size);
+    SudokuServer server(opts.serve_path, opts.workers, cache, opts.timeout);
+
+    running_server = &server;
+    ::signal(SIGINT, &stopServer);
+    ::signal(SIGTERM, &stopServer);
+
+    if (opts.verbose)
+        std::cerr << "Serving on '" << opts.serve_path << "' with "
+                  << opts.workers << " worker(s)" << std::endl;
+
+    int ret = EXIT_SUCCESS;
+    try {
+        server.run();
+    } catch (const ServerError& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        ret = EXIT_FAILURE;
+    }
+
+    ::signal(SIGINT, SIG_DFL);
+    ::signal(SIGTERM, SIG_DFL);
+    running_server = NULL;
+
+    if (opts.stats && cache != NULL)
+        printCacheStats(std::cerr, cache->stats());
+    delete cache;
+    return ret;
+}
+
+
+void stopServer(int)
+{
+    if (running_server != NULL)
+        running_server->stop();
+}
+
+
+int runCanonicalizer(const Options& opts)
+{
+    SudokuOutputter* outputter = createGridOutputter(opts, std::cout);
+    outputter->setBufferSize(BATCH_OUTPUT_BUFFER_SIZE);
+
+    std::vector<Grid> grids;
+    std::vector<std::thread> threads;
+    const size_t batch_size = opts.workers * CANONICALIZE_BATCH_SIZE;
+
+    Timer timer;
+    size_t total = 0;
+    int ret = EXIT_SUCCESS;
+    try {
+        std::ifstream file;
+        SudokuReader reader(openInput(opts, file));
+
+        bool more = true;
+        while (more) {
+            grids.clear();
+            while (more && grids.size() < batch_size) {
+                try {
+                    Grid grid;
+                    more = reader.read(grid);
+                    if (more)
+                        grids.push_back(grid);
+                } catch (const IOError& e) {
+                    std::cerr << "Error: IO error '" << e.what() << "'"
+                              << std::endl;
+                }
+            }
+
+            // One slice per worker, the last one in this thread
+            size_t slice = (grids.size() + opts.workers - 1) / opts.workers;
+            size_t begin = 0;
+            for (; begin + slice < grids.size(); begin += slice) {
+                threads.push_back(std::thread(&canonicalizeGrids,
+                                              std::ref(grids), begin,
+                                              begin + slice));
+            }
+            canonicalizeGrids(grids, begin, grids.size());
+            for (size_t i = 0; i < threads.size(); ++i)
+                threads[i].join();
+            threads.clear();
+
+            for (size_t i = 0; i < grids.size(); ++i)
+                outputter->output(grids[i]);
+            total += grids.size();
+        }
+    } catch (const IOError& e) {
+        std::cerr << "Error: IO error '" << e.what() << "'" << std::endl;
+        ret = EXIT_FAILURE;
+    }
+    outputter->flush();
+    delete outputter;
+
+    if (opts.timings) {
+        double seconds = timer.elapsed();
+        std::cerr << "/**" << std::endl
+                  << " * Canonicalized " << total << " grid(s) in "
+                  << std::fixed << std::setprecision(3) << seconds
+                  << " s with " << opts.workers << " worker(s), "
+                  << std::setprecision(0)
+                  << (seconds > 0 ? total / seconds : 0.0) << " grids/s"
+                  << std::endl << " */" << std::endl;
+    }
+    return ret;
+}
+
+
+void canonicalizeGrids(std::vector<Grid>& grids, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i)
+        grids[i] = canonicalize(grids[i]);
+}
+
+
+int runRater(const Options& opts)
+{
+    std::vector<Grid> grids;
+    std::vector<PuzzleRater::Rating> ratings;
+    std::vector<std::thread> threads;
+    const size_t batch_size = opts.workers * RATE_BATCH_SIZE;
+
+    // Puzzles by the hardest technique they need
+    std::vector<size_t> hardest(PuzzleRater::NUM_TECHNIQUES, 0);
+    double total_score = 0;
+
+    Timer timer;
+    size_t total = 0;
+    int ret = EXIT_SUCCESS;
+    try {
+        std::ifstream file;
+        SudokuReader reader(openInput(opts, file));
+
+        bool more = true;
+        while (more) {
+            grids.clear();
+            while (more && grids.size() < batch_size) {
+                try {
+                    Grid grid;
+                    more = reader.read(grid);
+                    if (more)
+                        grids.push_back(grid);
+                } catch (const IOError& e) {
+                    std::cerr << "Error: IO error '" << e.what() << "'"
+                              << std::endl;
+                }
+            }
+            ratings.resize(grids.size());
+
+            // One slice per worker, the last one in this thread
+            size_t slice = (grids.size() + opts.workers - 1) / opts.workers;
+            size_t begin = 0;
+            for (; begin + slice < grids.size(); begin += slice) {
+                threads.push_back(std::thread(&rateGrids, std::cref(grids),
+                                              std::ref(ratings), begin,
+                                              begin + slice));
+            }
+            rateGrids(grids, ratings, begin, grids.size());
+            for (size_t i = 0; i < threads.size(); ++i)
+                threads[i].join();
+            threads.clear();
+
+            // "<puzzle> <score> <technique>", nothing else is buffered
+            std::ios_base::fmtflags flags = std::cout.flags();
+            std::streamsize precision = std::cout.precision();
+            std::cout << std::fixed << std::setprecision(1);
+            for (size_t i = 0; i < grids.size(); ++i) {
+                const PuzzleRater::Rating& rating = ratings[i];
+                if (!rating.valid) {
+                    std::cerr << "Error: There is no solution for '"
+                              << grids[i].toString() << "'" << std::endl;
+                    continue;
+                }
+                if (!opts.null_output)
+                    std::cout << grids[i].toString() << ' ' << rating.score
+                              << ' '
+                              << PuzzleRater::techniqueName(rating.hardest)
+                              << '\n';
+                hardest[rating.hardest] += 1;
+                total_score += rating.score;
+                total += 1;
+            }
+            std::cout.flags(flags);
+            std::cout.precision(precision);
+        }
+    } catch (const IOError& e) {
+        std::cerr << "Error: IO error '" << e.what() << "'" << std::endl;
+        ret = EXIT_FAILURE;
+    }
+    std::cout.flush();
+
+    if (opts.stats && total > 0) {
+        std::cerr << "/**" << std::endl
+                  << " * Ratings of " << total << " puzzle(s), mean "
+                  << std::fixed << std::setprecision(2)
+                  << total_score / total << std::endl;
+        for (int i = 0; i < PuzzleRater::NUM_TECHNIQUES; ++i) {
+            PuzzleRater::Technique technique =
+                static_cast<PuzzleRater::Technique>(i);
+            if (hardest[i] == 0)
+                continue;
+            std::cerr << " *   " << std::left << std::setw(22)
+                      << PuzzleRater::techniqueName(technique) << std::right
+                      << std::setw(10) << hardest[i] << std::endl;
+        }
+        std::cerr << " */" << std::endl;
+    }
+    if (opts.timings) {
+        double seconds = timer.elapsed();
+        std::cerr << "/**" << std::endl
+                  << " * Rated " << total << " puzzle(s) in "
+                  << std::fixed << std::setprecision(3) << seconds
+                  << " s with " << opts.workers << " worker(s), "
+                  << std::setprecision(0)
+                  << (seconds > 0 ? total / seconds : 0.0) << " puzzles/s"
+                  << std::endl << " */" << std::endl;
+    }
+    return ret;
+}
+
+
+void rateGrids(const std::vector<Grid>& grids,
+               std::vector<PuzzleRater::Rating>& ratings, size_t begin,
+               size_t end)
+{
+    PuzzleRater rater;
+    for (size_t i = begin; i < end; ++i)
+        ratings[i] = rater.rate(grids[i]);
+}
+
+
+int runMinimalityChecker(const Options& opts)
+{
+    std::vector<Grid> grids;
+    std::vector<SudokuSolver::MINIMALITY> results;
+    std::vector<Grid> redundant;
+    std::vector<std::thread> threads;
+    const size_t batch_size = opts.workers * CHECK_BATCH_SIZE;
+
+    // Puzzles by answer, as SudokuSolver::MINIMALITY
+    size_t answers[SudokuSolver::NO_SOLUTION + 1] = { 0 };
+
+    Timer timer;
+    size_t total = 0;
+    int ret = EXIT_SUCCESS;
+    try {
+        std::ifstream file;
+        SudokuReader reader(openInput(opts, file));
+
+        bool more = true;
+        while (more) {
+            grids.clear();
+            while (more && grids.size() < batch_size) {
+                try {
+                    Grid grid;
+                    more = reader.read(grid);
+                    if (more)
+                        grids.push_back(grid);
+                } catch (const IOError& e) {
+                    std::cerr << "Error: IO error '" << e.what() << "'"
+                              << std::endl;
+                }
+            }
+            results.resize(grids.size());
+            redundant.resize(grids.size());
+
+            // One slice per worker, the last one in this thread
+            size_t slice = (grids.size() + opts.workers - 1) / opts.workers;
+            size_t begin = 0;
+            for (; begin + slice < grids.size(); begin += slice) {
+                threads.push_back(std::thread(&checkGrids, std::cref(grids),
+                                              std::ref(results),
+                                              std::ref(redundant), begin,
+                                              begin + slice));
+            }
+            checkGrids(grids, results, redundant, begin, grids.size());
+            for (size_t i = 0; i < threads.size(); ++i)
+                threads[i].join();
+            threads.clear();
+
+            // "<puzzle> <answer>", nothing else is buffered
+            for (size_t i = 0; i < grids.size(); ++i) {
+                answers[results[i]] += 1;
+                total += 1;
+                if (results[i] == SudokuSolver::NO_SOLUTION) {
+                    std::cerr << "Error: There is no solution for '"
+                              << grids[i].toString() << "'" << std::endl;
+                    continue;
+                }
+                if (opts.null_output)
+                    continue;
+
+                std::cout << grids[i].toString();
+                if (results[i] == SudokuSolver::MINIMAL) {
+                    std::cout << " minimal\n";
+                } else if (results[i] == SudokuSolver::NOT_UNIQUE) {
+                    std::cout << " not unique\n";
+                } else {
+                    std::cout << " redundant";
+                    printClues(std::cout, redundant[i]);
+                    std::cout << '\n';
+                }
+            }
+        }
+    } catch (const IOError& e) {
+        std::cerr << "Error: IO error '" << e.what() << "'" << std::endl;
+        ret = EXIT_FAILURE;
+    }
+    std::cout.flush();
+
+    if (opts.stats && total > 0) {
+        std::cerr << "/**" << std::endl
+                  << " * Checked " << total << " puzzle(s)" << std::endl
+                  << " *   minimal     " << std::setw(10)
+                  << answers[SudokuSolver::MINIMAL] << std::endl
+                  << " *   redundant   " << std::setw(10)
+                  << answers[SudokuSolver::NOT_MINIMAL] << std::endl
+                  << " *   not unique  " << std::setw(10)
+                  << answers[SudokuSolver::NOT_UNIQUE] << std::endl
+                  << " *   no solution " << std::setw(10)
+                  << answers[SudokuSolver::NO_SOLUTION] << std::endl
+                  << " */" << std::endl;
+    }
+    if (opts.timings) {
+        double seconds = timer.elapsed();
+        std::cerr << "/**" << std::endl
+                  << " * Checked " << total << " puzzle(s) in "
+                  << std::fixed << std::setprecision(3) << seconds
+                  << " s with " << opts.workers << " worker(s), "
+                  << std::setprecision(0)
+                  << (seconds > 0 ? total / seconds : 0.0) << " puzzles/s"
+                  << std::endl << " */" << std::endl;
+    }
+    return ret;
+}
+
+
+void checkGrids(const std::vector<Grid>& grids,
+                std::vector<SudokuSolver::MINIMALITY>& results,
+                std::vector<Grid>& redundant, size_t begin, size_t end)
+{
+    SudokuSolver engine;
+    for (size_t i = begin; i < end; ++i)
+        results[i] = engine.checkMinimal(grids[i], redundant[i]);
+}
+
+
+int runHinter(const Options& opts)
+{
+    // A single rater, consecutive grids of a game reuse its candidates
+    PuzzleRater rater;
+    size_t total = 0;
+    double seconds = 0;
+    int ret = EXIT_SUCCESS;
+    try {
+        std::ifstream file;
+        SudokuReader reader(openInput(opts, file));
+
+        bool more = true;
+        while (more) {
+            try {
+                Grid grid;
+                more = reader.read(grid);
+                if (!more)
+                    break;
+
+                Timer timer;
+                PuzzleRater::Hint hint = rater.hint(grid);
+                seconds += timer.elapsed();
+                total += 1;
+
+                if (hint.row < 0)
+                    std::cout << "none" << std::endl;
+                else
+                    std::cout << hint.row + 1 << ' ' << hint.column + 1 << ' '
+                              << hint.value << ' '
+                              << PuzzleRater::techniqueName(hint.technique)
+                              << std::endl;
+            } catch (const IOError& e) {
+                std::cerr << "Error: IO error '" << e.what() << "'"
+                          << std::endl;
+            }
+        }
+    } catch (const IOError& e) {
+        std::cerr << "Error: IO error '" << e.what() << "'" << std::endl;
+        ret = EXIT_FAILURE;
+    }
+
+    if (opts.timings && total > 0) {
+        std::cerr << "/**" << std::endl
+                  << " * " << total << " hint(s), mean " << std::fixed
+                  << std::setprecision(1) << seconds / total * 1e6 << " us"
+                  << std::endl << " */" << std::endl;
+    }
+    return ret;
+}
+
+
+int runGenerator(const Options& opts)
+{
+    SudokuOutputter* outputter = createGridOutputter(opts, std::cout);
+
+    GeneratorRun run;
+    run.filter = opts.filter;
+    run.count = opts.generate;
+    run.pairs = opts.pairs_output;
+    run.claimed = 0;
+    run.outputter = outputter;
+    run.stats = PuzzleGenerator::Stats();
+
+    if (opts.verbose)
+        std::cerr << "Generating " << opts.generate << " puzzle(s) with "
+                  << opts.workers << " worker(s), seed " << opts.seed
+                  << std::endl;
+
+    // Every worker has its own generator, seeded apart
+    Timer timer;
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < opts.workers; ++i)
+        threads.push_back(std::thread(&generatePuzzles, std::ref(run),
+                                      opts.seed + i));
+    generatePuzzles(run, opts.seed);
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    double seconds = timer.elapsed();
+    delete outputter;
+
+    if (opts.stats) {
+        std::cerr << "/**" << std::endl
+                  << " * Generator stats of " << run.count << " puzzle(s)"
+                  << std::endl
+                  << " *   grids " << run.stats.grids
+                  << ", uniqueness checks " << run.stats.checks
+                  << ", rejected " << run.stats.rejected << std::endl
+                  << " */" << std::endl;
+    }
+    if (opts.timings) {
+        std::cerr << "/**" << std::endl
+                  << " * Generated " << run.count << " puzzle(s) in "
+                  << std::fixed << std::setprecision(3) << seconds
+                  << " s, " << std::setprecision(1)
+                  << (seconds > 0 ? run.count / seconds : 0.0)
+                  << " puzzles/s" << std::endl << " */" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
+
+
+void generatePuzzles(GeneratorRun& run, unsigned long seed)
+{
+    PuzzleGenerator generator(seed);
+    Grid puzzle, solution;
+
+    while (run.claimed++ < run.count) {
+        generator.generate(run.filter, puzzle, solution);
+
+        // Written as soon as they are found
+        std::lock_guard<std::mutex> lock(run.mutex);
+        if (run.pairs)
+            run.outputter->output(puzzle, solution);
+        else
+            run.outputter->output(puzzle);
+        run.outputter->flush();
+    }
+
+    const PuzzleGenerator::Stats& stats = generator.stats();
+    std::lock_guard<std::mutex> lock(run.mutex);
+    run.stats.grids += stats.grids;
+    run.stats.checks += stats.checks;
+    run.stats.rejected += stats.rejected;
+}
+
+
+int runSampler(const Options& opts)
+{
+    SudokuOutputter* outputter = createGridOutputter(opts, std::cout);
+    outputter->setBufferSize(BATCH_OUTPUT_BUFFER_SIZE);
+
+    SamplerRun run;
+    run.method = opts.sampler;
+    run.shuffle = opts.shuffle;
+    run.count = opts.sample;
+    run.claimed = 0;
+    run.outputter = outputter;
+    run.stats = GridSampler::Stats();
+
+    if (opts.verbose)
+        std::cerr << "Sampling " << opts.sample << " grid(s) with "
+                  << opts.workers << " worker(s), seed " << opts.seed
+                  << std::endl;
+
+    Timer timer;
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < opts.workers; ++i)
+        threads.push_back(std::thread(&sampleGrids, std::ref(run),
+                                      opts.seed + i));
+    sampleGrids(run, opts.seed);
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    outputter->flush();
+    double seconds = timer.elapsed();
+    delete outputter;
+
+    if (!run.error.empty()) {
+        std::cerr << "Error: " << run.error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (opts.stats) {
+        std::cerr << "/**" << std::endl
+                  << " * Sampler stats of " << run.stats.grids << " grid(s)"
+                  << std::endl
+                  << " *   backtracks " << run.stats.backtracks << std::endl
+                  << " */" << std::endl;
+    }
+    if (opts.timings) {
+        std::cerr << "/**" << std::endl
+                  << " * Sampled " << run.count << " grid(s) in "
+                  << std::fixed << std::setprecision(3) << seconds
+                  << " s, " << std::setprecision(0)
+                  << (seconds > 0 ? run.count / seconds : 0.0)
+                  << " grids/s" << std::endl << " */" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
+
+
+void sampleGrids(SamplerRun& run, unsigned long seed)
+{
+    GridSampler sampler(seed, run.method);
+    sampler.setShuffle(run.shuffle);
+    std::vector<Grid> grids(SAMPLE_BATCH_SIZE);
+
+    while (true) {
+        // Claims a batch, the last one may be shorter
+        size_t first = run.claimed.fetch_add(SAMPLE_BATCH_SIZE);
+        if (first >= run.count)
+            break;
+        size_t size = std::min(SAMPLE_BATCH_SIZE, run.count - first);
+
+        try {
+            for (size_t i = 0; i < size; ++i)
+                sampler.sample(grids[i]);
+        } catch (const std::runtime_error& e) {
+            // The other threads stop at their next batch
+            run.claimed.store(run.count);
+            std::lock_guard<std::mutex> lock(run.mutex);
+            if (run.error.empty())
+                run.error = e.what();
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(run.mutex);
+        for (size_t i = 0; i < size; ++i)
+            run.outputter->output(grids[i]);
+    }
+
+    const GridSampler::Stats& stats = sampler.stats();
+    std::lock_guard<std::mutex> lock(run.mutex);
+    run.stats.grids += stats.grids;
+    run.stats.backtracks += stats.backtracks;
 }
 
 
@@ -127,7 +1087,30 @@ Options readParameters(int argc, char* argv[])
     opts.help = false;
     opts.verbose = false;
     opts.simple_output = false;
+    opts.line_output = false;
+    opts.pairs_output = false;
+    opts.null_output = false;
+    opts.binary_output = false;
+    opts.stats = false;
+    opts.timings = false;
+    opts.canonicalize = false;
+    opts.rate = false;
+    opts.hint = false;
+    opts.explain = false;
+    opts.check_minimal = false;
+    opts.jsonl = false;
+    opts.generate = 0;
+    opts.seed = static_cast<unsigned long>(::time(NULL));
+    opts.filter = PuzzleGenerator::anyPuzzle();
+    opts.sample = 0;
+    opts.sampler = GridSampler::SEARCH;
+    opts.shuffle = false;
     opts.file_path = "";
+    opts.serve_path = "";
+    opts.workers = std::max(1u, std::thread::hardware_concurrency());
+    opts.cache_size = 0;
+    opts.timeout = 0;
+    opts.memory_budget = 0;
 
     // argument parsing
     for (int i = 1; i < argc; ++i) {
@@ -137,6 +1120,101 @@ Options readParameters(int argc, char* argv[])
             opts.verbose = true;
         } else if (streq("-s", argv[i]) || streq("--simple", argv[i])) {
             opts.simple_output = true;
+        } else if (streq("-l", argv[i]) || streq("--line", argv[i])) {
+            opts.line_output = true;
+        } else if (streq("-p", argv[i]) || streq("--pairs", argv[i])) {
+            opts.line_output = true;
+            opts.pairs_output = true;
+        } else if (streq("-n", argv[i]) || streq("--null", argv[i])) {
+            opts.null_output = true;
+        } else if (streq("-b", argv[i]) || streq("--binary", argv[i])) {
+            opts.binary_output = true;
+        } else if (streq("--stats", argv[i])) {
+            opts.stats = true;
+        } else if (streq("-t", argv[i]) || streq("--timings", argv[i])) {
+            opts.timings = true;
+        } else if (streq("--canonicalize", argv[i])) {
+            opts.canonicalize = true;
+        } else if (streq("--rate", argv[i])) {
+            opts.rate = true;
+        } else if (streq("--hint", argv[i])) {
+            opts.hint = true;
+        } else if (streq("--explain", argv[i])) {
+            opts.explain = true;
+        } else if (streq("--check-minimal", argv[i])) {
+            opts.check_minimal = true;
+        } else if (streq("--jsonl", argv[i])) {
+            opts.jsonl = true;
+        } else if (streq("--generate", argv[i]) && i + 1 < argc) {
+            int count = atoi(argv[++i]);
+            if (count > 0)
+                opts.generate = static_cast<size_t>(count);
+            else
+                std::cerr << "Warning: Invalid number of puzzles '"
+                          << argv[i] << "' ... ignored." << std::endl;
+        } else if (streq("--sample", argv[i]) && i + 1 < argc) {
+            int count = atoi(argv[++i]);
+            if (count > 0)
+                opts.sample = static_cast<size_t>(count);
+            else
+                std::cerr << "Warning: Invalid number of grids '"
+                          << argv[i] << "' ... ignored." << std::endl;
+        } else if (streq("--sampler", argv[i]) && i + 1 < argc) {
+            ++i;
+            if (streq("search", argv[i]))
+                opts.sampler = GridSampler::SEARCH;
+            else if (streq("sat", argv[i]))
+                opts.sampler = GridSampler::SAT;
+            else
+                std::cerr << "Warning: Unknown sampler '" << argv[i]
+                          << "' ... ignored." << std::endl;
+        } else if (streq("--shuffle", argv[i])) {
+            opts.shuffle = true;
+        } else if (streq("--seed", argv[i]) && i + 1 < argc) {
+            opts.seed = strtoul(argv[++i], NULL, 10);
+        } else if (streq("--min-clues", argv[i]) && i + 1 < argc) {
+            opts.filter.min_clues = atoi(argv[++i]);
+        } else if (streq("--max-clues", argv[i]) && i + 1 < argc) {
+            opts.filter.max_clues = atoi(argv[++i]);
+        } else if (streq("--min-decisions", argv[i]) && i + 1 < argc) {
+            opts.filter.min_decisions = strtoul(argv[++i], NULL, 10);
+        } else if (streq("--max-decisions", argv[i]) && i + 1 < argc) {
+            opts.filter.max_decisions = strtoul(argv[++i], NULL, 10);
+        } else if (streq("--min-rating", argv[i]) && i + 1 < argc) {
+            opts.filter.min_rating = atof(argv[++i]);
+        } else if (streq("--max-rating", argv[i]) && i + 1 < argc) {
+            opts.filter.max_rating = atof(argv[++i]);
+        } else if (streq("--serve", argv[i]) && i + 1 < argc) {
+            opts.serve_path = std::string(argv[++i]);
+        } else if ((streq("-w", argv[i]) || streq("--workers", argv[i])) &&
+                   i + 1 < argc) {
+            int workers = atoi(argv[++i]);
+            if (workers > 0)
+                opts.workers = static_cast<size_t>(workers);
+            else
+                std::cerr << "Warning: Invalid number of workers '"
+                          << argv[i] << "' ... ignored." << std::endl;
+        } else if (streq("--cache", argv[i]) && i + 1 < argc) {
+            int cache_size = atoi(argv[++i]);
+            if (cache_size > 0)
+                opts.cache_size = static_cast<size_t>(cache_size);
+            else
+                std::cerr << "Warning: Invalid cache size '"
+                          << argv[i] << "' ... ignored." << std::endl;
+        } else if (streq("--max-memory", argv[i]) && i + 1 < argc) {
+            int megabytes = atoi(argv[++i]);
+            if (megabytes > 0)
+                opts.memory_budget = static_cast<size_t>(megabytes) << 20;
+            else
+                std::cerr << "Warning: Invalid memory budget '"
+                          << argv[i] << "' ... ignored." << std::endl;
+        } else if (streq("--timeout", argv[i]) && i + 1 < argc) {
+            int timeout = atoi(argv[++i]);
+            if (timeout > 0)
+                opts.timeout = timeout / 1000.0;
+            else
+                std::cerr << "Warning: Invalid timeout '"
+                          << argv[i] << "' ... ignored." << std::endl;
         } else {
             if (!opts.file_path.empty()) {
                 std::cerr << "Warning: More than one file specified ..."
@@ -153,12 +1231,29 @@ Options readParameters(int argc, char* argv[])
 
 SudokuOutputter* createSudokuOutputter(const Options& opts, std::ostream& stream)
 {
+    if (opts.null_output)
+        return new SudokuNullOutputter(stream);
+    if (opts.binary_output)
+        return new SudokuBinaryOutputter(stream, opts.pairs_output);
+    if (opts.line_output)
+        return new SudokuLineOutputter(stream, opts.pairs_output);
     if (opts.simple_output)
         return new SudokuSimpleOutputter(stream);
     return new SudokuFormattedOutputter(stream);
 }
 
 
+// Outputter of the modes that print many grids, one per line by default
+SudokuOutputter* createGridOutputter(const Options& opts, std::ostream& stream)
+{
+    if (opts.null_output)
+        return new SudokuNullOutputter(stream);
+    if (opts.binary_output)
+        return new SudokuBinaryOutputter(stream, opts.pairs_output);
+    return new SudokuLineOutputter(stream, opts.pairs_output);
+}
+
+
 
 //
 void printHelp(const char* bin_path)
@@ -173,6 +1268,77 @@ void printHelp(const char* bin_path)
     std::cout << std::endl;
     //coutln("\t\t-a/--all      computes all the possible solutions [TODO].");
     coutln("\t\t-s/--simple   print sudoku without formatting.");
+    coutln("\t\t-l/--line     print every sudoku in a single line.");
+    coutln("\t\t-p/--pairs    print \"<puzzle>,<solution>\" lines.");
+    coutln("\t\t-n/--null     do not print the solutions (benchmarking).");
+    coutln("\t\t-b/--binary   print every grid as 81 bytes, the values of");
+    coutln("\t\t              its cells or 0 if empty.");
+    coutln("\t\t--stats       print the solver counters of every sudoku and");
+    coutln("\t\t              their aggregate to the standard error.");
+    coutln("\t\t-t/--timings  print the time spent parsing, encoding,");
+    coutln("\t\t              solving, extracting and formatting to the");
+    coutln("\t\t              standard error, per sudoku if verbose.");
+    coutln("\t\t--serve PATH  solve the sudokus sent to the Unix socket PATH");
+    coutln("\t\t              until interrupted, one \"<puzzle>\" line per");
+    coutln("\t\t              request and \"OK <solution>\", \"UNSAT\",");
+    coutln("\t\t              \"UNKNOWN\" or \"ERROR <reason>\" per response.");
+    coutln("\t\t--canonicalize  print the minimal lexicographic form of");
+    coutln("\t\t              every sudoku instead of solving it, equal");
+    coutln("\t\t              lines for sudokus equal up to symmetry.");
+    coutln("\t\t--rate        print \"<puzzle> <score> <technique>\" for");
+    coutln("\t\t              every sudoku, the hardest technique a person");
+    coutln("\t\t              needs to solve it and its Sudoku Explainer");
+    coutln("\t\t              score. With --stats prints how many need");
+    coutln("\t\t              every technique.");
+    coutln("\t\t--hint        print \"<row> <column> <value> <technique>\"");
+    coutln("\t\t              for every sudoku, the next value a person");
+    coutln("\t\t              could place, or \"none\".");
+    coutln("\t\t--explain     print \"Conflicting clues: <row> <column>");
+    coutln("\t\t              <value>, ...\" after every sudoku without a");
+    coutln("\t\t              solution, a minimal set of its values that");
+    coutln("\t\t              has no solution either.");
+    coutln("\t\t--check-minimal  print \"<puzzle> minimal\", \"<puzzle>");
+    coutln("\t\t              not unique\" or \"<puzzle> redundant <row>");
+    coutln("\t\t              <column> <value>, ...\" for every sudoku, the");
+    coutln("\t\t              values that can be removed keeping its");
+    coutln("\t\t              solution unique.");
+    coutln("\t\t--jsonl       read JSON Lines records such as {\"id\": 1,");
+    coutln("\t\t              \"puzzle\": \"<puzzle>\"} and print one per");
+    coutln("\t\t              record with its id, \"status\" and");
+    coutln("\t\t              \"solution\", plus \"stats\" with --stats and");
+    coutln("\t\t              \"timings\" with -t.");
+    coutln("\t\t--generate N  print N new minimal puzzles with a unique");
+    coutln("\t\t              solution, one per line, or with their");
+    coutln("\t\t              solution if -p is given.");
+    coutln("\t\t--min-clues N, --max-clues N  only print the generated");
+    coutln("\t\t              puzzles with that many clues.");
+    coutln("\t\t--min-decisions N, --max-decisions N  only print the");
+    coutln("\t\t              generated puzzles the solver needs that");
+    coutln("\t\t              many decisions to solve.");
+    coutln("\t\t--min-rating X, --max-rating X  only print the generated");
+    coutln("\t\t              puzzles with a --rate score in that range.");
+    coutln("\t\t--sample N    print N random filled grids.");
+    coutln("\t\t--sampler M   how --sample fills the grids: \"search\",");
+    coutln("\t\t              randomized backtracking, the default, or");
+    coutln("\t\t              \"sat\", the solver with random phases.");
+    coutln("\t\t--shuffle     apply a random symmetry to every sampled");
+    coutln("\t\t              grid.");
+    coutln("\t\t--seed N      seed of --generate and --sample, the time");
+    coutln("\t\t              by default.");
+    coutln("\t\t-w/--workers N  threads solving the requests of --serve,");
+    coutln("\t\t              canonicalizing, rating, checking,");
+    coutln("\t\t              generating or sampling, one per core by");
+    coutln("\t\t              default.");
+    coutln("\t\t--cache N     remember the results of the last N sudokus,");
+    coutln("\t\t              up to symmetry, and answer repeated ones");
+    coutln("\t\t              without solving them. With --stats prints");
+    coutln("\t\t              the hit rate and the lookup costs.");
+    coutln("\t\t--max-memory MB  give up on the sudokus, or the requests of");
+    coutln("\t\t              --serve, whose solver holds more than MB");
+    coutln("\t\t              megabytes, the solver is rebuilt then.");
+    coutln("\t\t--timeout MS  give up on every sudoku, or every request of");
+    coutln("\t\t              --serve since it is read, after MS");
+    coutln("\t\t              milliseconds.");
     coutln("\t\tsudoku_file   file with the sudoku initial values.");
     coutln("\t\t              If not specified reads from the standard input.");
 
@@ -184,51 +1350,215 @@ void printHelp(const char* bin_path)
     std::cout << std::endl;
     coutln("\tThe file must be composed by lines with the following format:");
     coutln("\t\t<row> <column> value");
+    std::cout << std::endl;
+    coutln("\tAlternatively, the file may contain one sudoku per line, each");
+    coutln("\tgiven as 81 characters from the top left cell to the bottom");
+    coutln("\tright one, with '.' or '0' for the empty cells. Empty lines and");
+    coutln("\tlines starting with '#' are ignored.");
 }
 
 
 //------------------------------------------------------------------------------
 //
 
-void loadSudoku(const Options& opts, Sudoku& sudoku)
+std::istream& openInput(const Options& opts, std::ifstream& file)
 {
     if (opts.file_path.empty()) {
         if (opts.verbose)
             std::cout << "/**" << std::endl
                       << " * Loading from standard output ..." << std::endl
                       << " */" << std::endl;
-        loadSudoku(std::cin, sudoku);
-    } else {
-        std::ifstream file(opts.file_path.c_str());
-        if (!file.is_open()) {
-            throw IOError("Unable to open file: " + opts.file_path);
-        }
-        if (opts.verbose)
-            std::cout << "/**" << std::endl 
-                      << " * Loading from '" << opts.file_path << "'" 
-                      << std::endl << " */" << std::endl;
+        return std::cin;
+    }
 
-        loadSudoku(file, sudoku);
-        file.close();
+    file.open(opts.file_path.c_str());
+    if (!file.is_open()) {
+        throw IOError("Unable to open file: " + opts.file_path);
     }
+    if (opts.verbose)
+        std::cout << "/**" << std::endl
+                  << " * Loading from '" << opts.file_path << "'"
+                  << std::endl << " */" << std::endl;
+    return file;
+}
+
+
+//------------------------------------------------------------------------------
+//
+
+void addStats(RunSummary& summary, const Solver::Stats& stats,
+              const Arena::Stats& arena_stats)
+{
+    Solver::Stats& total = summary.total;
+    Solver::Stats& max = summary.max;
+
+    total.decisions += stats.decisions;
+    total.propagations += stats.propagations;
+    total.conflicts += stats.conflicts;
+    total.visits += stats.visits;
+    total.seconds += stats.seconds;
+    total.variables += stats.variables;
+    total.original_clauses += stats.original_clauses;
+    total.peak_bytes += stats.peak_bytes;
+
+    max.decisions = std::max(max.decisions, stats.decisions);
+    max.propagations = std::max(max.propagations, stats.propagations);
+    max.conflicts = std::max(max.conflicts, stats.conflicts);
+    max.visits = std::max(max.visits, stats.visits);
+    max.seconds = std::max(max.seconds, stats.seconds);
+    max.variables = std::max(max.variables, stats.variables);
+    max.original_clauses = std::max(max.original_clauses,
+                                    stats.original_clauses);
+    max.peak_bytes = std::max(max.peak_bytes, stats.peak_bytes);
+
+    Arena::Stats& arena_total = summary.arena_total;
+    Arena::Stats& arena_max = summary.arena_max;
+
+    arena_total.allocations += arena_stats.allocations;
+    arena_total.peak_bytes += arena_stats.peak_bytes;
+    arena_total.reserved_bytes += arena_stats.reserved_bytes;
+
+    arena_max.allocations = std::max(arena_max.allocations,
+                                     arena_stats.allocations);
+    arena_max.peak_bytes = std::max(arena_max.peak_bytes,
+                                    arena_stats.peak_bytes);
+    arena_max.reserved_bytes = std::max(arena_max.reserved_bytes,
+                                        arena_stats.reserved_bytes);
+    // Counted since the arena was created, the last value is the total
+    arena_total.system_allocations = arena_stats.system_allocations;
+    arena_max.system_allocations = arena_stats.system_allocations;
 }
 
-void loadSudoku(std::istream& is, Sudoku& sudoku)
+// A single line per sudoku, starting with '#' like the comments of the
+// line format
+void printStats(std::ostream& os, size_t sudoku_num,
+                const Solver::Stats& stats, const Arena::Stats& arena_stats)
 {
-   int row, column, value;
-   int line = 0;
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
 
-    while (is.good()) {
-        is >> row >> column >> value;
-        
-        if ((is.bad() || is.fail()) && !is.eof()) {  // Add option to ignore errors
-            std::ostringstream oss;
-            oss << "Error loading sudoku. Line: " << line;
-            is.clear();
-            throw IOError(oss.str());
-        } else if (!is.fail()) {
-            line += 1;
-            sudoku.setValue(--row, --column, value);
-        }
-    }
+    os << "# sudoku " << sudoku_num
+       << ": decisions " << stats.decisions
+       << ", propagations " << stats.propagations
+       << ", conflicts " << stats.conflicts
+       << ", visits " << stats.visits
+       << ", seconds " << std::fixed << std::setprecision(6) << stats.seconds
+       << ", variables " << stats.variables
+       << ", original clauses " << stats.original_clauses
+       << ", peak bytes " << stats.peak_bytes
+       << ", arena allocations " << arena_stats.allocations
+       << ", arena peak bytes " << arena_stats.peak_bytes
+       << ", arena reserved bytes " << arena_stats.reserved_bytes
+       << ", system allocations " << arena_stats.system_allocations
+       << std::endl;
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+#define STATS_ROW(name, total, max) \
+    os << " *   " << std::left << std::setw(22) << name << std::right \
+       << std::setw(14) << total \
+       << std::setw(16) << total / sudokus \
+       << std::setw(14) << max << std::endl
+
+void printStatsSummary(std::ostream& os, const RunSummary& summary)
+{
+    if (summary.sudokus == 0)
+        return;
+
+    double sudokus = static_cast<double>(summary.sudokus);
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    os << "/**" << std::endl
+       << " * Solver stats of " << summary.sudokus << " sudoku(s)" << std::endl
+       << " *   " << std::setw(22) << "" << std::setw(14) << "total"
+       << std::setw(16) << "mean" << std::setw(14) << "max" << std::endl;
+
+    os << std::fixed << std::setprecision(1);
+    STATS_ROW("decisions", summary.total.decisions, summary.max.decisions);
+    STATS_ROW("propagations", summary.total.propagations,
+              summary.max.propagations);
+    STATS_ROW("conflicts", summary.total.conflicts, summary.max.conflicts);
+    STATS_ROW("visits", summary.total.visits, summary.max.visits);
+    os << std::setprecision(6);
+    STATS_ROW("seconds", summary.total.seconds, summary.max.seconds);
+    os << std::setprecision(1);
+    STATS_ROW("variables", summary.total.variables, summary.max.variables);
+    STATS_ROW("original clauses", summary.total.original_clauses,
+              summary.max.original_clauses);
+    STATS_ROW("peak bytes", summary.total.peak_bytes, summary.max.peak_bytes);
+    STATS_ROW("arena allocations", summary.arena_total.allocations,
+              summary.arena_max.allocations);
+    STATS_ROW("arena peak bytes", summary.arena_total.peak_bytes,
+              summary.arena_max.peak_bytes);
+    STATS_ROW("arena reserved bytes", summary.arena_total.reserved_bytes,
+              summary.arena_max.reserved_bytes);
+    STATS_ROW("system allocations", summary.arena_total.system_allocations,
+              summary.arena_max.system_allocations);
+
+    os << " */" << std::endl;
+    os.flags(flags);
+    os.precision(precision);
+}
+
+#undef STATS_ROW
+
+void printCacheStats(std::ostream& os, const SolutionCache::Stats& stats)
+{
+    if (stats.lookups == 0)
+        return;
+
+    double lookups = static_cast<double>(stats.lookups);
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    os << "/**" << std::endl
+       << " * Cache stats of " << stats.lookups << " lookup(s)" << std::endl
+       << std::fixed << std::setprecision(1)
+       << " *   hits " << stats.hits << " ("
+       << 100.0 * static_cast<double>(stats.hits) / lookups << "%)"
+       << ", entries " << stats.entries
+       << ", evictions " << stats.evictions << std::endl
+       << " *   canonicalize mean "
+       << stats.canonicalize_seconds / lookups * 1e6
+       << " us, lookup mean " << stats.lookup_seconds / lookups * 1e6
+       << " us" << std::endl
+       << " */" << std::endl;
+    os.flags(flags);
+    os.precision(precision);
+}
+
+void printTimings(std::ostream& os, size_t sudoku_num, double parse,
+                  const Sudoku::Timings& timings, double format)
+{
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    os << "# sudoku " << sudoku_num << std::fixed << std::setprecision(1)
+       << ": parse " << parse * 1e6
+       << " us, encode " << timings.encode * 1e6
+       << " us, solve " << timings.solve * 1e6
+       << " us, extract " << timings.extract * 1e6
+       << " us, format " << format * 1e6 << " us" << std::endl;
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+void printTimingsSummary(std::ostream& os, const RunSummary& summary)
+{
+    if (summary.sudokus == 0)
+        return;
+
+    os << "/**" << std::endl
+       << " * Phase timings of " << summary.sudokus << " sudoku(s)"
+       << std::endl << " */" << std::endl;
+
+    summary.parse.print(os, "parse");
+    summary.encode.print(os, "encode");
+    summary.solve.print(os, "solve");
+    summary.extract.print(os, "extract");
+    summary.format.print(os, "format");
 }
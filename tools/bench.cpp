@@ -0,0 +1,521 @@
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdexcept>
+
+#include "Grid.hpp"
+#include "SudokuSolver.hpp"
+#include "SudokuReader.hpp"
+
+
+using namespace sudoku;
+
+
+//
+// Benchmark harness, solves every puzzle of the given corpora with every
+// solver configuration and reports the latency per puzzle and throughput.
+//
+
+
+// Local types
+// --------------------------------------------------------
+struct Options
+{
+    bool help;
+    int warmup_runs;
+    int runs;
+    int generated;
+    unsigned seed;
+    std::string json_path;
+    std::vector<std::string> corpora;
+};
+
+
+struct Puzzle
+{
+    unsigned char cells[81];
+};
+
+
+struct Corpus
+{
+    std::string name;
+    std::vector<Puzzle> puzzles;
+};
+
+
+// A way of solving a puzzle, every corpus is run with all of them
+struct Config
+{
+    const char* name;
+    Solver::SOLVE_RESULT (*solve)(const Puzzle&, Solver::Stats&);
+};
+
+
+struct Result
+{
+    std::string corpus;
+    std::string config;
+    size_t puzzles;
+    int runs;
+    size_t satisfiable;
+    size_t unsatisfiable;
+    size_t unknown;
+    double mean_us;
+    double p50_us;
+    double p99_us;
+    double max_us;
+    double puzzles_per_sec;
+    double mean_decisions;
+    double mean_propagations;
+    unsigned long long max_decisions;
+    unsigned long long max_propagations;
+};
+
+
+typedef std::chrono::steady_clock Clock;
+
+
+// Function prototypes
+// --------------------------------------------------------
+Options readParameters(int argc, char *argv[]);
+void printHelp(const char* bin_path);
+
+void loadCorpus(const std::string& path, Corpus& corpus);
+void generateCorpus(const std::vector<Corpus>& sources, int count,
+                    unsigned seed, Corpus& corpus);
+Puzzle shufflePuzzle(const Puzzle& puzzle, std::mt19937& rng);
+
+Result runBenchmark(const Corpus& corpus, const Config& config,
+                    const Options& opts);
+double percentile(const std::vector<double>& sorted, double p);
+
+Solver::SOLVE_RESULT solveWithSudoku(const Puzzle& puzzle,
+                                     Solver::Stats& stats);
+Solver::SOLVE_RESULT solveWithRebuild(const Puzzle& puzzle,
+                                      Solver::Stats& stats);
+Solver::SOLVE_RESULT solveWithEngine(SudokuSolver& engine,
+                                     const Puzzle& puzzle,
+                                     Solver::Stats& stats);
+
+void printResults(const std::vector<Result>& results, std::ostream& os);
+void writeJson(const std::vector<Result>& results, const Options& opts,
+               std::ostream& os);
+
+
+// Configurations
+// --------------------------------------------------------
+const Config CONFIGS[] = {
+    { "sat", &solveWithSudoku },
+    { "sat-rebuild", &solveWithRebuild },
+};
+
+const size_t NUM_CONFIGS = sizeof(CONFIGS) / sizeof(CONFIGS[0]);
+
+
+// Local utility inline functions
+// -----------------------------------------------------------------------------
+
+#define coutln(X) (std::cout << X << std::endl)
+
+inline bool streq(const char* str1, const char* str2)
+{
+    return strcmp(str1, str2) == 0;
+}
+
+
+// Functions
+// -----------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    Options opts = readParameters(argc, argv);
+
+    if (opts.help || opts.corpora.empty()) {
+        printHelp(argv[0]);
+        return opts.help ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::vector<Corpus> corpora;
+    try {
+        for (size_t i = 0; i < opts.corpora.size(); ++i) {
+            corpora.push_back(Corpus());
+            loadCorpus(opts.corpora[i], corpora.back());
+        }
+    } catch (const IOError& e) {
+        std::cerr << "Error: IO error '" << e.what() << "'" << std::endl;
+        return EXIT_FAILURE;
+    } catch (const std::out_of_range& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (opts.generated > 0) {
+        Corpus generated;
+        generateCorpus(corpora, opts.generated, opts.seed, generated);
+        corpora.push_back(generated);
+    }
+
+    std::vector<Result> results;
+    for (size_t c = 0; c < NUM_CONFIGS; ++c) {
+        for (size_t i = 0; i < corpora.size(); ++i) {
+            if (!corpora[i].puzzles.empty())
+                results.push_back(runBenchmark(corpora[i], CONFIGS[c], opts));
+        }
+    }
+
+    printResults(results, std::cout);
+
+    if (!opts.json_path.empty()) {
+        std::ofstream file(opts.json_path.c_str());
+        if (!file.is_open()) {
+            std::cerr << "Error: Unable to open file: " << opts.json_path
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+        writeJson(results, opts, file);
+        coutln("Results written to '" << opts.json_path << "'");
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+// Reads user command line parameters
+Options readParameters(int argc, char* argv[])
+{
+    Options opts;
+
+    // default values
+    opts.help = false;
+    opts.warmup_runs = 1;
+    opts.runs = 5;
+    opts.generated = 1000;
+    opts.seed = 2014;
+    opts.json_path = "";
+
+    // argument parsing
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (streq("-h", argv[i]) || streq("--help", argv[i])) {
+            opts.help = true;
+        } else if (streq("--warmup", argv[i]) && has_value) {
+            opts.warmup_runs = std::max(0, atoi(argv[++i]));
+        } else if (streq("--runs", argv[i]) && has_value) {
+            opts.runs = std::max(1, atoi(argv[++i]));
+        } else if (streq("--generated", argv[i]) && has_value) {
+            opts.generated = std::max(0, atoi(argv[++i]));
+        } else if (streq("--seed", argv[i]) && has_value) {
+            opts.seed = static_cast<unsigned>(strtoul(argv[++i], NULL, 10));
+        } else if (streq("--json", argv[i]) && has_value) {
+            opts.json_path = argv[++i];
+        } else {
+            opts.corpora.push_back(argv[i]);
+        }
+    }
+
+    return opts;
+}
+
+
+//
+void printHelp(const char* bin_path)
+{
+    coutln("Usage: " << bin_path << " [Options] corpus [corpus ...]");
+
+    std::cout << std::endl;
+    coutln("\tOptions:");
+    coutln("\t\t-h/--help        print this message and exit.");
+    coutln("\t\t--warmup N       unmeasured runs over every corpus (1).");
+    coutln("\t\t--runs N         measured runs over every corpus (5).");
+    coutln("\t\t--generated N    puzzles of the generated corpus, random");
+    coutln("\t\t                 symmetries of the given ones (1000).");
+    coutln("\t\t--seed S         seed of the generated corpus (2014).");
+    coutln("\t\t--json FILE      also write the results as JSON.");
+    coutln("\t\tcorpus           file with one or more sudokus in any of");
+    coutln("\t\t                 the formats accepted by sudoku-solver.");
+}
+
+
+//------------------------------------------------------------------------------
+//
+
+void loadCorpus(const std::string& path, Corpus& corpus)
+{
+    std::ifstream file(path.c_str());
+    if (!file.is_open())
+        throw IOError("Unable to open file: " + path);
+
+    size_t slash = path.find_last_of('/');
+    corpus.name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+
+    SudokuReader reader(file);
+    while (true) {
+        Grid grid;
+        if (!reader.read(grid))
+            break;
+
+        Puzzle puzzle;
+        const Grid::Cells& cells = grid.getCells();
+        std::copy(cells.begin(), cells.end(), puzzle.cells);
+        corpus.puzzles.push_back(puzzle);
+    }
+}
+
+// Random members of the same symmetry class as the given puzzles, so they
+// have the same solvability but a different encoding order for the solver
+void generateCorpus(const std::vector<Corpus>& sources, int count,
+                    unsigned seed, Corpus& corpus)
+{
+    std::vector<const Puzzle*> pool;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        for (size_t j = 0; j < sources[i].puzzles.size(); ++j)
+            pool.push_back(&sources[i].puzzles[j]);
+    }
+
+    std::ostringstream oss;
+    oss << "generated-" << count;
+    corpus.name = oss.str();
+
+    if (pool.empty())
+        return;
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, pool.size() - 1);
+    for (int i = 0; i < count; ++i)
+        corpus.puzzles.push_back(shufflePuzzle(*pool[pick(rng)], rng));
+}
+
+// Applies a random digit relabeling, band/stack permutation, row/column
+// permutation inside every band/stack and transposition
+Puzzle shufflePuzzle(const Puzzle& puzzle, std::mt19937& rng)
+{
+    int digits[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    std::shuffle(digits + 1, digits + 10, rng);
+
+    int rows[9], columns[9];
+    int bands[3] = { 0, 1, 2 };
+    int stacks[3] = { 0, 1, 2 };
+    std::shuffle(bands, bands + 3, rng);
+    std::shuffle(stacks, stacks + 3, rng);
+    for (int b = 0; b < 3; ++b) {
+        int band_rows[3] = { 0, 1, 2 };
+        int stack_columns[3] = { 0, 1, 2 };
+        std::shuffle(band_rows, band_rows + 3, rng);
+        std::shuffle(stack_columns, stack_columns + 3, rng);
+        for (int k = 0; k < 3; ++k) {
+            rows[b * 3 + k] = bands[b] * 3 + band_rows[k];
+            columns[b * 3 + k] = stacks[b] * 3 + stack_columns[k];
+        }
+    }
+    bool transpose = (rng() & 1) != 0;
+
+    Puzzle shuffled;
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 9; ++j) {
+            int src = transpose ? columns[j] * 9 + rows[i]
+                                : rows[i] * 9 + columns[j];
+            shuffled.cells[i * 9 + j] =
+                static_cast<unsigned char>(digits[puzzle.cells[src]]);
+        }
+    }
+    return shuffled;
+}
+
+
+//------------------------------------------------------------------------------
+//
+
+Result runBenchmark(const Corpus& corpus, const Config& config,
+                    const Options& opts)
+{
+    Result result;
+    result.corpus = corpus.name;
+    result.config = config.name;
+    result.puzzles = corpus.puzzles.size();
+    result.runs = opts.runs;
+    result.satisfiable = result.unsatisfiable = result.unknown = 0;
+    result.max_decisions = result.max_propagations = 0;
+
+    Solver::Stats stats;
+    for (int r = 0; r < opts.warmup_runs; ++r) {
+        for (size_t i = 0; i < corpus.puzzles.size(); ++i)
+            config.solve(corpus.puzzles[i], stats);
+    }
+
+    double total_decisions = 0;
+    double total_propagations = 0;
+
+    std::vector<double> latencies;
+    latencies.reserve(corpus.puzzles.size() * opts.runs);
+
+    Clock::time_point bench_start = Clock::now();
+    for (int r = 0; r < opts.runs; ++r) {
+        for (size_t i = 0; i < corpus.puzzles.size(); ++i) {
+            Clock::time_point start = Clock::now();
+            Solver::SOLVE_RESULT res = config.solve(corpus.puzzles[i], stats);
+            Clock::time_point end = Clock::now();
+
+            latencies.push_back(
+                std::chrono::duration<double, std::micro>(end - start).count());
+
+            total_decisions += stats.decisions;
+            total_propagations += stats.propagations;
+            result.max_decisions =
+                std::max(result.max_decisions, stats.decisions);
+            result.max_propagations =
+                std::max(result.max_propagations, stats.propagations);
+
+            if (r == 0) {  // results are the same in every run
+                if (res == Solver::SATISFIABLE)
+                    ++result.satisfiable;
+                else if (res == Solver::UNSATISFIABLE)
+                    ++result.unsatisfiable;
+                else
+                    ++result.unknown;
+            }
+        }
+    }
+    double elapsed = std::chrono::duration<double>(
+        Clock::now() - bench_start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    double total_us = 0;
+    for (size_t i = 0; i < latencies.size(); ++i)
+        total_us += latencies[i];
+
+    result.mean_us = total_us / latencies.size();
+    result.p50_us = percentile(latencies, 0.50);
+    result.p99_us = percentile(latencies, 0.99);
+    result.max_us = latencies.back();
+    result.puzzles_per_sec = elapsed > 0 ? latencies.size() / elapsed : 0;
+    result.mean_decisions = total_decisions / latencies.size();
+    result.mean_propagations = total_propagations / latencies.size();
+
+    return result;
+}
+
+// Nearest rank percentile of a sorted, non empty, sample
+double percentile(const std::vector<double>& sorted, double p)
+{
+    size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+    if (rank < 1)
+        rank = 1;
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+
+//------------------------------------------------------------------------------
+// Configurations
+
+Solver::SOLVE_RESULT solveWithSudoku(const Puzzle& puzzle,
+                                     Solver::Stats& stats)
+{
+    static SudokuSolver engine;
+    return solveWithEngine(engine, puzzle, stats);
+}
+
+// Rebuilds the solver and its base formula for every puzzle, which is what
+// creating a solver per puzzle costs
+Solver::SOLVE_RESULT solveWithRebuild(const Puzzle& puzzle,
+                                      Solver::Stats& stats)
+{
+    static SolverPool pool(&SudokuSolver::addRulesConstraints, 0, 1);
+    static SudokuSolver engine(pool);
+    return solveWithEngine(engine, puzzle, stats);
+}
+
+Solver::SOLVE_RESULT solveWithEngine(SudokuSolver& engine,
+                                     const Puzzle& puzzle,
+                                     Solver::Stats& stats)
+{
+    Grid::Cells cells;
+    std::copy(puzzle.cells, puzzle.cells + Grid::NUM_CELLS, cells.begin());
+
+    Grid solution;
+    Solver::SOLVE_RESULT res = engine.solve(Grid(cells), solution);
+    stats = engine.getSolverStats();
+    return res;
+}
+
+
+//------------------------------------------------------------------------------
+// Reports
+
+void printResults(const std::vector<Result>& results, std::ostream& os)
+{
+    os << std::left << std::setw(32) << "corpus"
+       << std::setw(8) << "config" << std::right
+       << std::setw(8) << "puzzles"
+       << std::setw(11) << "mean(us)"
+       << std::setw(11) << "p50(us)"
+       << std::setw(11) << "p99(us)"
+       << std::setw(11) << "max(us)"
+       << std::setw(12) << "puzzles/s"
+       << std::setw(11) << "decisions"
+       << std::setw(10) << "props"
+       << std::setw(8) << "unsat"
+       << std::setw(8) << "unknown" << std::endl;
+
+    os << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        os << std::left << std::setw(32) << r.corpus
+           << std::setw(8) << r.config << std::right
+           << std::setw(8) << r.puzzles
+           << std::setw(11) << r.mean_us
+           << std::setw(11) << r.p50_us
+           << std::setw(11) << r.p99_us
+           << std::setw(11) << r.max_us
+           << std::setw(12) << r.puzzles_per_sec
+           << std::setw(11) << r.mean_decisions
+           << std::setw(10) << r.mean_propagations
+           << std::setw(8) << r.unsatisfiable
+           << std::setw(8) << r.unknown << std::endl;
+    }
+}
+
+void writeJson(const std::vector<Result>& results, const Options& opts,
+               std::ostream& os)
+{
+    os << "{" << std::endl
+       << "  \"warmup_runs\": " << opts.warmup_runs << "," << std::endl
+       << "  \"runs\": " << opts.runs << "," << std::endl
+       << "  \"seed\": " << opts.seed << "," << std::endl
+       << "  \"results\": [" << std::endl;
+
+    os << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        os << "    {"
+           << "\"corpus\": \"" << r.corpus << "\", "
+           << "\"config\": \"" << r.config << "\", "
+           << "\"puzzles\": " << r.puzzles << ", "
+           << "\"runs\": " << r.runs << ", "
+           << "\"satisfiable\": " << r.satisfiable << ", "
+           << "\"unsatisfiable\": " << r.unsatisfiable << ", "
+           << "\"unknown\": " << r.unknown << ", "
+           << "\"mean_us\": " << r.mean_us << ", "
+           << "\"p50_us\": " << r.p50_us << ", "
+           << "\"p99_us\": " << r.p99_us << ", "
+           << "\"max_us\": " << r.max_us << ", "
+           << "\"puzzles_per_sec\": " << r.puzzles_per_sec << ", "
+           << "\"mean_decisions\": " << r.mean_decisions << ", "
+           << "\"max_decisions\": " << r.max_decisions << ", "
+           << "\"mean_propagations\": " << r.mean_propagations << ", "
+           << "\"max_propagations\": " << r.max_propagations
+           << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+
+    os << "  ]" << std::endl << "}" << std::endl;
+}
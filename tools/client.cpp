@@ -0,0 +1,374 @@
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <stdexcept>
+
+#include "Grid.hpp"
+#include "SudokuReader.hpp"
+
+
+using namespace sudoku;
+
+
+//
+// Load generator for 'sudoku-solver --serve', sends the puzzles of the
+// given files through several connections, keeping a number of requests
+// in flight on each, and reports the latency and throughput.
+//
+
+
+// Local types
+// --------------------------------------------------------
+struct Options
+{
+    bool help;
+    bool print;
+    int connections;
+    int depth;
+    int repeat;
+    std::string socket_path;
+    std::vector<std::string> files;
+};
+
+
+// Responses and latencies seen by one connection
+struct Tally
+{
+    size_t ok;
+    size_t unsat;
+    size_t unknown;
+    size_t errors;
+    std::vector<double> latencies_us;
+    std::vector<std::string> responses;     // only kept to print them
+};
+
+
+typedef std::chrono::steady_clock Clock;
+
+
+// Function prototypes
+// --------------------------------------------------------
+Options readParameters(int argc, char *argv[]);
+void printHelp(const char* bin_path);
+
+void loadPuzzles(const std::string& path, std::vector<std::string>& puzzles);
+int connectTo(const std::string& path);
+void runConnection(const Options& opts,
+                   const std::vector<std::string>& puzzles, size_t first,
+                   size_t count, Tally& tally);
+void countResponse(const std::string& response, Tally& tally);
+double percentile(const std::vector<double>& sorted, double p);
+
+
+// Local utility inline functions
+// -----------------------------------------------------------------------------
+
+#define coutln(X) (std::cout << X << std::endl)
+
+inline bool streq(const char* str1, const char* str2)
+{
+    return strcmp(str1, str2) == 0;
+}
+
+
+// Functions
+// -----------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    Options opts = readParameters(argc, argv);
+
+    if (opts.help || opts.socket_path.empty() || opts.files.empty()) {
+        printHelp(argv[0]);
+        return opts.help ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::vector<std::string> puzzles;
+    try {
+        for (size_t i = 0; i < opts.files.size(); ++i)
+            loadPuzzles(opts.files[i], puzzles);
+    } catch (const IOError& e) {
+        std::cerr << "Error: IO error '" << e.what() << "'" << std::endl;
+        return EXIT_FAILURE;
+    } catch (const std::out_of_range& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::string> requests;
+    for (int r = 0; r < opts.repeat; ++r)
+        requests.insert(requests.end(), puzzles.begin(), puzzles.end());
+
+    // Every connection sends a contiguous slice of the requests
+    size_t connections = static_cast<size_t>(opts.connections);
+    std::vector<Tally> tallies(connections, Tally());
+    std::vector<std::thread> threads;
+
+    Clock::time_point start = Clock::now();
+    try {
+        size_t first = 0;
+        for (size_t c = 0; c < connections; ++c) {
+            size_t count = requests.size() / connections +
+                (c < requests.size() % connections ? 1 : 0);
+            threads.push_back(std::thread(runConnection, std::cref(opts),
+                                          std::cref(requests), first, count,
+                                          std::ref(tallies[c])));
+            first += count;
+        }
+    } catch (const std::system_error& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    for (size_t c = 0; c < threads.size(); ++c)
+        threads[c].join();
+    double seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+
+    Tally total = Tally();
+    for (size_t c = 0; c < tallies.size(); ++c) {
+        total.ok += tallies[c].ok;
+        total.unsat += tallies[c].unsat;
+        total.unknown += tallies[c].unknown;
+        total.errors += tallies[c].errors;
+        total.latencies_us.insert(total.latencies_us.end(),
+                                  tallies[c].latencies_us.begin(),
+                                  tallies[c].latencies_us.end());
+        if (opts.print) {
+            for (size_t i = 0; i < tallies[c].responses.size(); ++i)
+                std::cout << tallies[c].responses[i] << '\n';
+        }
+    }
+    std::cout.flush();
+
+    std::vector<double>& latencies = total.latencies_us;
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0;
+    for (size_t i = 0; i < latencies.size(); ++i)
+        sum += latencies[i];
+
+    std::ostream& os = opts.print ? std::cerr : std::cout;
+    os << std::fixed << std::setprecision(1);
+    os << "requests:    " << requests.size() << " (" << total.ok << " ok, "
+       << total.unsat << " unsat, " << total.unknown << " unknown, "
+       << total.errors << " errors)" << std::endl;
+    os << "answered:    " << latencies.size() << " through " << connections
+       << " connection(s), " << opts.depth << " in flight each" << std::endl;
+    if (!latencies.empty()) {
+        os << "latency us:  mean " << sum / latencies.size()
+           << ", p50 " << percentile(latencies, 0.50)
+           << ", p99 " << percentile(latencies, 0.99)
+           << ", max " << latencies.back() << std::endl;
+    }
+    os << "throughput:  " << (seconds > 0 ? latencies.size() / seconds : 0)
+       << " requests/s in " << std::setprecision(3) << seconds << " s"
+       << std::endl;
+
+    return latencies.size() == requests.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+// Reads user command line parameters
+Options readParameters(int argc, char* argv[])
+{
+    Options opts;
+
+    // default values
+    opts.help = false;
+    opts.print = false;
+    opts.connections = 1;
+    opts.depth = 16;
+    opts.repeat = 1;
+    opts.socket_path = "";
+
+    // argument parsing
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (streq("-h", argv[i]) || streq("--help", argv[i])) {
+            opts.help = true;
+        } else if (streq("--print", argv[i])) {
+            opts.print = true;
+        } else if (streq("--connections", argv[i]) && has_value) {
+            opts.connections = std::max(1, atoi(argv[++i]));
+        } else if (streq("--depth", argv[i]) && has_value) {
+            opts.depth = std::max(1, atoi(argv[++i]));
+        } else if (streq("--repeat", argv[i]) && has_value) {
+            opts.repeat = std::max(1, atoi(argv[++i]));
+        } else if (opts.socket_path.empty()) {
+            opts.socket_path = argv[i];
+        } else {
+            opts.files.push_back(argv[i]);
+        }
+    }
+
+    return opts;
+}
+
+
+//
+void printHelp(const char* bin_path)
+{
+    coutln("Usage: " << bin_path << " [Options] socket file [file ...]");
+
+    std::cout << std::endl;
+    coutln("\tOptions:");
+    coutln("\t\t-h/--help         print this message and exit.");
+    coutln("\t\t--connections N   connections opened to the server (1).");
+    coutln("\t\t--depth N         requests in flight per connection (16).");
+    coutln("\t\t--repeat N        times every puzzle is sent (1).");
+    coutln("\t\t--print           print the responses, connection by");
+    coutln("\t\t                  connection, and the report to the");
+    coutln("\t\t                  standard error.");
+    coutln("\t\tsocket            Unix socket of 'sudoku-solver --serve'.");
+    coutln("\t\tfile              puzzles in any format of sudoku-solver.");
+}
+
+
+//------------------------------------------------------------------------------
+//
+
+void loadPuzzles(const std::string& path, std::vector<std::string>& puzzles)
+{
+    std::ifstream file(path.c_str());
+    if (!file.is_open())
+        throw IOError("Unable to open file: " + path);
+
+    SudokuReader reader(file);
+    Grid grid;
+    while (reader.read(grid)) {
+        puzzles.push_back(grid.toString());
+        grid = Grid();
+    }
+}
+
+
+int connectTo(const std::string& path)
+{
+    sockaddr_un addr;
+    ::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        return -1;
+    ::strcpy(addr.sun_path, path.c_str());
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+// Sends requests [first, first + count) keeping opts.depth in flight
+void runConnection(const Options& opts,
+                   const std::vector<std::string>& requests, size_t first,
+                   size_t count, Tally& tally)
+{
+    static std::mutex error_mutex;
+
+    if (count == 0)
+        return;
+
+    int fd = connectTo(opts.socket_path);
+    if (fd < 0) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        std::cerr << "Error: Unable to connect to '" << opts.socket_path
+                  << "': " << ::strerror(errno) << std::endl;
+        return;
+    }
+
+    std::deque<Clock::time_point> sent;
+    size_t next = first;
+    const size_t end = first + count;
+    std::string out, in;
+    char buffer[16 * 1024];
+    tally.latencies_us.reserve(count);
+
+    while (next < end || !sent.empty()) {
+        // Top the pipeline up with a single write
+        out.clear();
+        while (next < end && sent.size() < static_cast<size_t>(opts.depth)) {
+            out += requests[next++];
+            out += '\n';
+            sent.push_back(Clock::now());
+        }
+        for (size_t pos = 0; pos < out.size(); ) {
+            ssize_t n = ::send(fd, out.data() + pos, out.size() - pos,
+                               MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                ::close(fd);
+                return;
+            }
+            pos += n;
+        }
+
+        // Wait for at least one response
+        ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        in.append(buffer, n);
+
+        size_t pos = 0, eol;
+        while ((eol = in.find('\n', pos)) != std::string::npos) {
+            Clock::time_point now = Clock::now();
+            tally.latencies_us.push_back(std::chrono::duration<double,
+                std::micro>(now - sent.front()).count());
+            sent.pop_front();
+
+            std::string response = in.substr(pos, eol - pos);
+            countResponse(response, tally);
+            if (opts.print)
+                tally.responses.push_back(response);
+            pos = eol + 1;
+        }
+        in.erase(0, pos);
+    }
+
+    ::close(fd);
+}
+
+
+void countResponse(const std::string& response, Tally& tally)
+{
+    if (response.compare(0, 3, "OK ") == 0)
+        ++tally.ok;
+    else if (response == "UNSAT")
+        ++tally.unsat;
+    else if (response == "UNKNOWN")
+        ++tally.unknown;
+    else
+        ++tally.errors;
+}
+
+
+// Nearest rank percentile of an ascending sorted sample
+double percentile(const std::vector<double>& sorted, double p)
+{
+    size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+    if (rank < 1)
+        rank = 1;
+    return sorted[std::min(rank, sorted.size()) - 1];
+}